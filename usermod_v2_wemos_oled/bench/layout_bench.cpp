@@ -0,0 +1,101 @@
+// Layout benchmark: draws the LED info screen hand-coded (`drawIcons` + `drawLedInfo`)
+// and as a user-defined screen compiled from layouts/led_screen.txt, compares time
+// per frame and checks both produce the same image.
+// Usage: layout_bench LAYOUT_FILE
+
+#include "wemos_oled.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int FRAMES = 200;
+static constexpr int ROUNDS = 501;      // odd, median of per-round ratios is reported
+static constexpr double TOLERANCE = 1.03; // host timing noise, see "Benchmarks" in README.md
+
+struct WemosOledBench {
+    using WO = WemosOledUsermod;
+
+    static WO* start() {
+        WO* um = new WO();
+        um->enabled = true;
+        um->setup(); // loads layout file
+        return um;
+    }
+
+    static uint8_t layoutCount(WO* um) {
+        return um->layoutCount;
+    }
+
+    // ns per drawn frame in a single round
+    static double round(WO* um, bool custom) {
+        um->activeScreen = custom ? WO::Screen::CUSTOM : WO::Screen::LED;
+        um->fillFrame();
+        WO::Frame& f = um->frame;
+        auto t0 = Clock::now();
+        for (int i = 0; i < FRAMES; ++i) {
+            um->drawFrame(f);
+        }
+        std::chrono::duration<double, std::nano> dt = Clock::now() - t0;
+        return dt.count() / FRAMES;
+    }
+
+    // rounds of both screens are interleaved so host frequency changes affect them alike,
+    // best times are reported and the median ratio of adjacent rounds is compared
+    static double measure(WO* um, double& hand, double& layout, uint8_t* handImage, uint8_t* layoutImage) {
+        double ratios[ROUNDS];
+        for (int r = 0; r < ROUNDS; ++r) {
+            double handNs = round(um, false);
+            if (r == 0 || handNs < hand) hand = handNs;
+            memcpy(handImage, um->display.getBufferPtr(), WO::FRAME_SIZE);
+            double layoutNs = round(um, true);
+            if (r == 0 || layoutNs < layout) layout = layoutNs;
+            memcpy(layoutImage, um->display.getBufferPtr(), WO::FRAME_SIZE);
+            ratios[r] = layoutNs / handNs;
+        }
+        std::nth_element(ratios, ratios + ROUNDS / 2, ratios + ROUNDS);
+        return ratios[ROUNDS / 2];
+    }
+};
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        printf("usage: %s LAYOUT_FILE\n", argv[0]);
+        return 2;
+    }
+    std::ifstream file(argv[1], std::ios::binary);
+    WLED_FS.name = "/wemos_oled.bin";
+    WLED_FS.content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    WemosOledUsermod* um = WemosOledBench::start();
+    if (WemosOledBench::layoutCount(um) != 1) {
+        printf("FAIL: layout wasn't loaded\n");
+        return 1;
+    }
+
+    uint8_t handImage[384];
+    uint8_t layoutImage[384];
+    double hand = 0;
+    double layout = 0;
+    double ratio = WemosOledBench::measure(um, hand, layout, handImage, layoutImage);
+
+    printf("%d frames per round, best of %d rounds\n", FRAMES, ROUNDS);
+    printf("%-28s %10s\n", "LED screen", "ns/frame");
+    printf("%-28s %10.0f\n", "hand-coded", hand);
+    printf("%-28s %10.0f\n", "layout VM", layout);
+    printf("layout / hand-coded: %.3f (median of rounds)\n", ratio);
+
+    bool ok = true;
+    if (memcmp(handImage, layoutImage, sizeof(handImage)) != 0) {
+        printf("FAIL: layout image differs from hand-coded screen\n");
+        ok = false;
+    }
+    if (ratio > TOLERANCE) {
+        printf("FAIL: layout is more than %.0f%% slower than hand-coded screen\n", (TOLERANCE - 1) * 100);
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
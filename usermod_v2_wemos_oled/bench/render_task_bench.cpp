@@ -0,0 +1,132 @@
+// Render task benchmark: cost of `loop` calls that produce a new frame when
+// the frame is drawn and sent in `loop` and when it's handed to the render task.
+// The render task runs on std::thread (stubs/freertos.h), I2C transfers take
+// as long as on a 400 kHz bus. Fails if the task doesn't take the drawing and
+// sending off `loop`.
+
+#include "wemos_oled.h"
+
+#include <chrono>
+#include <cstdlib>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int FRAMES = 100;
+static constexpr int FRAME_PERIOD_MS = 15;  // real time between frames, longer than a transfer
+static constexpr uint32_t I2C_BYTES_PER_SEC = 400000 / 9; // 8 data bits and ack per byte
+
+struct Stats {
+    double mean = 0;
+    double max = 0;
+
+    void add(double us) {
+        mean += us / FRAMES;
+        max = std::max(max, us);
+    }
+};
+
+struct WemosOledBench {
+    // time screen changes every second, so every frame is different and gets flushed
+    static WemosOledUsermod* start(bool task) {
+        bench::failTaskCreate = !task;
+        WemosOledUsermod* um = new WemosOledUsermod(); // render task may use it forever
+        um->enabled = true;
+        um->setup();
+        um->loop(); // splash to wifi screen
+        um->activeScreen = WemosOledUsermod::Screen::TIME_AND_DATE;
+        return um;
+    }
+
+    static Stats measureLoop(WemosOledUsermod* um) {
+        Stats stats;
+        for (int i = 0; i < FRAMES; ++i) {
+            bench::now += 1000;
+            um->lastWokeUp = bench::now; // user is active, no screensaver
+            auto t0 = Clock::now();
+            um->loop();
+            std::chrono::duration<double, std::micro> dt = Clock::now() - t0;
+            stats.add(dt.count());
+            std::this_thread::sleep_for(std::chrono::milliseconds(FRAME_PERIOD_MS));
+        }
+        return stats;
+    }
+
+    static Stats measureFill(WemosOledUsermod* um) {
+        Stats stats;
+        for (int i = 0; i < FRAMES; ++i) {
+            auto t0 = Clock::now();
+            um->fillFrame();
+            std::chrono::duration<double, std::micro> dt = Clock::now() - t0;
+            stats.add(dt.count());
+        }
+        return stats;
+    }
+
+    static Stats measureCopy(WemosOledUsermod* um) {
+        static WemosOledUsermod::Frame copy;
+        Stats stats;
+        for (int i = 0; i < FRAMES; ++i) {
+            auto t0 = Clock::now();
+            memcpy(&copy, &um->frame, sizeof(copy));
+            std::chrono::duration<double, std::micro> dt = Clock::now() - t0;
+            stats.add(dt.count());
+            um->frame.id += copy.id & 1; // keep the copy alive
+        }
+        return stats;
+    }
+
+    static bool hasTask(WemosOledUsermod* um) {
+        return um->renderTask != nullptr;
+    }
+
+    static uint32_t flushes(WemosOledUsermod* um) {
+        return um->display.flushes;
+    }
+};
+
+static void report(const char* name, const Stats& stats) {
+    printf("%-28s %10.1f %10.1f\n", name, stats.mean, stats.max);
+}
+
+int main() {
+    bench::i2cBytesPerSec = I2C_BYTES_PER_SEC;
+
+    WemosOledUsermod* inlineUm = WemosOledBench::start(false);
+    uint32_t inlineFlushes = WemosOledBench::flushes(inlineUm);
+    Stats inlineLoop = WemosOledBench::measureLoop(inlineUm);
+    inlineFlushes = WemosOledBench::flushes(inlineUm) - inlineFlushes;
+
+    WemosOledUsermod* taskUm = WemosOledBench::start(true);
+    if (!WemosOledBench::hasTask(taskUm)) {
+        printf("FAIL: render task wasn't started\n");
+        return 1;
+    }
+    uint32_t taskFlushes = WemosOledBench::flushes(taskUm);
+    Stats taskLoop = WemosOledBench::measureLoop(taskUm);
+    taskFlushes = WemosOledBench::flushes(taskUm) - taskFlushes;
+
+    Stats fill = WemosOledBench::measureFill(taskUm);
+    Stats copy = WemosOledBench::measureCopy(taskUm);
+
+    printf("%d frames, I2C %u bytes/s\n", FRAMES, I2C_BYTES_PER_SEC);
+    printf("%-28s %10s %10s\n", "loop() with a new frame", "mean, us", "max, us");
+    report("render in loop", inlineLoop);
+    report("render task", taskLoop);
+    report("  fillFrame", fill);
+    report("  Frame memcpy", copy);
+    printf("frames flushed: %u in loop, %u by task\n", inlineFlushes, taskFlushes);
+
+    bool ok = true;
+    if (inlineFlushes != FRAMES || taskFlushes != FRAMES) {
+        printf("FAIL: expected every frame flushed\n");
+        ok = false;
+    }
+    // what remains in `loop` is the snapshot and the handover
+    if (taskLoop.mean * 10 > inlineLoop.mean) {
+        printf("FAIL: render task saves less than 90%% of loop time\n");
+        ok = false;
+    }
+    // render task keeps running, don't wait for it
+    fflush(stdout);
+    _Exit(ok ? 0 : 1);
+}
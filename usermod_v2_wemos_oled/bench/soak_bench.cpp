@@ -0,0 +1,308 @@
+// Soak benchmark: months of random use on a virtual clock. Every WLED loop
+// iteration calls `handleButton` for both buttons and then `loop`, millis()
+// wraps around several times. Reports per-call CPU cost, renders and I2C
+// traffic per simulated day. Fails on inactivity timeouts that fire early or
+// never, on lost button presses, on wrong uptime and on runaway redraws.
+// Usage: soak_bench [DAYS]
+
+#include "wemos_oled.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr uint64_t MINUTE_MS = 60000;
+static constexpr uint64_t HOUR_MS = 60 * MINUTE_MS;
+static constexpr uint64_t DAY_MS = 24 * HOUR_MS;
+static constexpr uint64_t START_MS = (uint64_t(1) << 32) - 3 * HOUR_MS; // first rollover comes soon
+static constexpr uint32_t STEP_MS = 50;            // virtual time between WLED loop iterations
+static constexpr uint32_t DEFAULT_DAYS = 100;      // three rollovers
+// user is away over the second rollover and comes back while millis() is
+// still below the timepoints of the last presses
+static constexpr uint64_t ABSENCE_START = 10 * DAY_MS;
+static constexpr uint64_t ABSENCE = 45 * DAY_MS;
+static constexpr uint32_t MAX_RENDERS_PER_MIN = 90; // clock rate gives 60, flips and pixel shift add a few
+static constexpr uint32_t RENDERS_PER_EVENT = 4;    // allowance for every press and state change
+static constexpr uint64_t SEED = 20231013;
+
+enum Flag : uint8_t {
+    SCREENSAVER_EARLY,
+    SCREENSAVER_LATE,
+    MENU_STUCK,
+    HIGHLIGHT_STUCK,
+    PRESS_LOST,
+    WRONG_UPTIME,
+    RUNAWAY_REDRAW,
+    FLAG_COUNT
+};
+
+static const char* const FLAG_NAMES[FLAG_COUNT] = {
+    "screensaver started early",
+    "screensaver never started",
+    "menu never closed",
+    "highlighting never ended",
+    "button press lost",
+    "wrong uptime",
+    "runaway redraw",
+};
+
+struct DayStats {
+    uint32_t loops = 0;
+    double loopNs = 0;      // sum of `loop` call times
+    double loopMaxUs = 0;
+    double buttonNs = 0;    // sum of `handleButton` pair times
+    uint32_t renders = 0;
+    uint32_t flushes = 0;
+    uint64_t busBytes = 0;
+    uint32_t presses = 0;
+    uint32_t flags[FLAG_COUNT] = {};
+    bool rollover = false;
+};
+
+struct WemosOledBench {
+    using WO = WemosOledUsermod;
+
+    WO* um = nullptr;
+    std::mt19937_64 rng{SEED};
+    uint64_t sim = START_MS;     // virtual ms since boot, millis() is its low half
+
+    // random user, presses come in sessions separated by idle periods
+    uint64_t nextPress = START_MS + MINUTE_MS;
+    uint64_t releaseAt = 0;
+    int8_t held = -1;            // pressed button
+    uint32_t sessionPresses = 0; // presses left in the current session
+    int8_t sessionButton = -1;   // the only button used in the session, -1 - both
+    bool absent = false;         // the long absence is over
+    uint64_t nextStateChange = START_MS;
+
+    // 64 bit copies of the usermod timepoints to check timeouts against
+    uint32_t wokeUp32 = 0;
+    uint64_t wokeUp = START_MS;
+    uint64_t accepted[2] = {};   // latest accepted press of each button
+    bool reported[FLAG_COUNT] = {};
+
+    uint64_t minute = 0;
+    uint32_t minuteRenders = 0;
+    uint32_t minuteEvents = 0;
+
+    DayStats day;
+
+    uint64_t uniform(uint64_t lo, uint64_t hi) {
+        return std::uniform_int_distribution<uint64_t>(lo, hi)(rng);
+    }
+
+    uint64_t exponential(uint64_t mean) {
+        return uint64_t(std::exponential_distribution<double>(1.0 / mean)(rng));
+    }
+
+    void start() {
+        bench::now = uint32_t(sim);
+        um = new WO();
+        um->enabled = true;
+        um->setup();
+        wokeUp32 = um->lastWokeUp;
+    }
+
+    // time to the next press within a session or to the next session
+    uint64_t pause() {
+        if (sessionPresses > 0) {
+            --sessionPresses;
+            // sometimes long enough to hit menu and highlight timeouts
+            return uniform(0, 9) == 0 ? uniform(20000, 60000) : uniform(200, 15000);
+        }
+        sessionPresses = uniform(0, 12);
+        // single button sessions leave the other button's timepoint stale for long
+        uint64_t style = uniform(0, 9);
+        sessionButton = style < 3 ? 1 : style < 5 ? 0 : -1;
+        if (!absent && sim >= START_MS + ABSENCE_START) {
+            absent = true;
+            return ABSENCE;
+        }
+        uint64_t r = uniform(0, 99);
+        if (r < 30) return uniform(5000, 5 * MINUTE_MS); // around the timeouts
+        if (r < 99) return 5000 + exponential(2 * HOUR_MS);
+        return uniform(1, 10) * DAY_MS;
+    }
+
+    // a user who doesn't reboot or reset the device
+    uint8_t pickButton() {
+        if (um->menu && (um->activeScreen == WO::Screen::MENU_REBOOT ||
+            um->activeScreen == WO::Screen::MENU_AP ||
+            um->activeScreen == WO::Screen::MENU_FACTORY_RESET)) return 0;
+        if (sessionButton >= 0) return sessionButton;
+        return uniform(0, 4) < 2 ? 0 : 1;
+    }
+
+    // returns pressed button or -1
+    int8_t input() {
+        if (held >= 0 && sim >= releaseAt) {
+            bench::buttons[held] = false;
+            held = -1;
+        }
+        if (sim >= nextStateChange) {
+            // brightness changed from the app or a sync packet
+            bri = uniform(1, 255);
+            stateChanged = true;
+            ++minuteEvents;
+            nextStateChange = sim + exponential(30 * MINUTE_MS);
+        }
+        if (held >= 0 || sim < nextPress) return -1;
+        held = pickButton();
+        bench::buttons[held] = true;
+        // action button is sometimes held to auto-repeat
+        bool hold = held == 1 && uniform(0, 9) == 0;
+        releaseAt = sim + (hold ? uniform(600, 3000) : uniform(60, 250));
+        nextPress = releaseAt + pause();
+        ++minuteEvents;
+        ++day.presses;
+        return held;
+    }
+
+    void flag(Flag f) {
+        if (reported[f]) return;
+        reported[f] = true;
+        ++day.flags[f];
+    }
+
+    // one WLED loop iteration
+    void step() {
+        sim += STEP_MS;
+        uint32_t last = bench::now;
+        bench::now = uint32_t(sim);
+        if (bench::now < last) {
+            ++rolloverMillis; // as WLED counts them
+            day.rollover = true;
+        }
+        int8_t pressed = input();
+
+        uint32_t frameId = um->frame.id;
+        auto t0 = Clock::now();
+        um->handleButton(0);
+        um->handleButton(1);
+        auto t1 = Clock::now();
+        bool savingAfterButtons = um->screenSaving;
+        um->loop();
+        auto t2 = Clock::now();
+        stateChanged = false; // WLED clears it once the change is handled
+
+        std::chrono::duration<double, std::nano> buttonNs = t1 - t0;
+        std::chrono::duration<double, std::nano> loopNs = t2 - t1;
+        ++day.loops;
+        day.buttonNs += buttonNs.count();
+        day.loopNs += loopNs.count();
+        day.loopMaxUs = std::max(day.loopMaxUs, loopNs.count() / 1000);
+        day.renders += um->frame.id - frameId;
+        minuteRenders += um->frame.id - frameId;
+
+        check(pressed, savingAfterButtons);
+    }
+
+    void check(int8_t pressed, bool savingAfterButtons) {
+        if (um->lastWokeUp != wokeUp32) {
+            wokeUp32 = um->lastWokeUp;
+            wokeUp = sim;
+            reported[SCREENSAVER_LATE] = reported[MENU_STUCK] = reported[HIGHLIGHT_STUCK] = false;
+        }
+        uint32_t lastPress[2] = {um->lastMenuPress, um->lastActionPress};
+        if (pressed >= 0) {
+            // a press after the debounce timeout must be taken
+            if (sim - accepted[pressed] >= um->btnTimeout && lastPress[pressed] != bench::now) {
+                reported[PRESS_LOST] = false;
+                flag(PRESS_LOST);
+            }
+            if (lastPress[pressed] == bench::now) accepted[pressed] = sim;
+        }
+        uint64_t inactive = sim - wokeUp;
+        // menu action may start screensaver right away, `loop` may not
+        if (um->screenSaving && !savingAfterButtons && inactive < um->screensaverTimeout) {
+            reported[SCREENSAVER_EARLY] = false;
+            flag(SCREENSAVER_EARLY);
+        }
+        if (!um->screenSaving && inactive >= um->screensaverTimeout + STEP_MS) {
+            flag(SCREENSAVER_LATE);
+        }
+        if (um->menu && inactive >= um->menuExitTimeout + STEP_MS) {
+            flag(MENU_STUCK);
+        }
+        if (um->highlighting && inactive >= um->highlightTimeout + STEP_MS) {
+            flag(HIGHLIGHT_STUCK);
+        }
+        if (sim / MINUTE_MS != minute) {
+            if (minuteRenders > MAX_RENDERS_PER_MIN + RENDERS_PER_EVENT * minuteEvents) {
+                reported[RUNAWAY_REDRAW] = false;
+                flag(RUNAWAY_REDRAW);
+            }
+            minute = sim / MINUTE_MS;
+            minuteRenders = 0;
+            minuteEvents = 0;
+        }
+    }
+
+    // uptime as shown on tech info screen, usermod state is left untouched
+    uint32_t uptime() {
+        WO::Frame saved = um->frame;
+        WO::Screen screen = um->activeScreen;
+        bool saving = um->screenSaving;
+        um->activeScreen = WO::Screen::TECH_INFO;
+        um->screenSaving = false;
+        um->fillFrame();
+        uint32_t result = um->frame.uptime;
+        um->frame = saved;
+        um->activeScreen = screen;
+        um->screenSaving = saving;
+        return result;
+    }
+
+    DayStats runDay() {
+        day = DayStats();
+        uint32_t flushes = um->display.flushes;
+        uint64_t busBytes = um->display.busBytes;
+        for (uint64_t i = 0; i < DAY_MS / STEP_MS; ++i) {
+            step();
+        }
+        day.flushes = um->display.flushes - flushes;
+        day.busBytes = um->display.busBytes - busBytes;
+        if (uptime() != sim / 1000) {
+            ++day.flags[WRONG_UPTIME];
+        }
+        return day;
+    }
+};
+
+int main(int argc, char** argv) {
+    uint32_t days = argc > 1 ? atoi(argv[1]) : DEFAULT_DAYS;
+    WemosOledBench soak;
+    soak.start();
+
+    printf("%u days, loop every %u ms, first millis() rollover after %llu min\n", days, STEP_MS,
+        (unsigned long long)(((uint64_t(1) << 32) - START_MS) / MINUTE_MS));
+    printf("%4s %2s %8s %8s %8s %8s %8s %8s %8s %6s\n", "day", "ro", "presses",
+        "loop ns", "max us", "btn ns", "renders", "flushes", "KB sent", "flags");
+    uint32_t totals[FLAG_COUNT] = {};
+    double loopNs = 0;
+    uint64_t loops = 0;
+    for (uint32_t d = 0; d < days; ++d) {
+        DayStats s = soak.runDay();
+        uint32_t flags = 0;
+        for (int f = 0; f < FLAG_COUNT; ++f) {
+            totals[f] += s.flags[f];
+            flags += s.flags[f];
+        }
+        loopNs += s.loopNs;
+        loops += s.loops;
+        printf("%4u %2s %8u %8.0f %8.1f %8.0f %8u %8u %8llu %6u\n", d + 1, s.rollover ? "*" : "",
+            s.presses, s.loopNs / s.loops, s.loopMaxUs, s.buttonNs / s.loops,
+            s.renders, s.flushes, (unsigned long long)(s.busBytes / 1024), flags);
+    }
+    printf("loop: %.0f ns per call over %llu calls\n", loopNs / loops, (unsigned long long)loops);
+
+    bool ok = true;
+    for (int f = 0; f < FLAG_COUNT; ++f) {
+        if (totals[f] == 0) continue;
+        printf("FAIL: %s, %u times\n", FLAG_NAMES[f], totals[f]);
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+// U8g2 full buffer SSD1306 64x48 stand-in.
+// Draws into a real page buffer (byte per 8 pixel column, bit 0 on top) with
+// a fake 5x7 font, so frames depend on their content like on the device.
+// The I2C bus is modelled by byte counters and an optional busy wait.
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+typedef uint8_t u8g2_uint_t;
+
+#define U8G2_R0 0
+#define U8G2_FONT_SECTION(name)
+
+extern const uint8_t u8g2_font_profont10_tr[], u8g2_font_profont10_tn[],
+    u8g2_font_profont17_mn[], u8g2_font_profont22_tn[],
+    u8g2_font_open_iconic_all_1x_t[], u8g2_font_open_iconic_embedded_4x_t[],
+    u8g2_font_open_iconic_www_4x_t[], u8g2_font_open_iconic_thing_4x_t[],
+    u8g2_font_open_iconic_play_4x_t[], u8g2_font_open_iconic_text_4x_t[],
+    u8g2_font_open_iconic_mime_4x_t[], u8g2_font_open_iconic_gui_4x_t[];
+
+namespace bench {
+    extern uint32_t i2cBytesPerSec;  // bus speed for the busy wait, 0 - transfers take no time
+}
+
+class U8G2_SSD1306_64X48_ER_F_HW_I2C {
+    static constexpr int WIDTH = 64;
+    static constexpr int HEIGHT = 48;
+    static constexpr uint32_t FRAME_BUS_BYTES = 440;  // 384 data bytes plus addressing and control
+    static constexpr uint32_t COMMAND_BUS_BYTES = 4;
+
+    uint8_t buffer[WIDTH * HEIGHT / 8];
+    uint8_t color = 1;
+    int cursorX = 0;
+    int cursorY = 0;
+
+    void transfer(uint32_t bytes) {
+        busBytes += bytes;
+        if (bench::i2cBytesPerSec == 0) return;
+        auto end = std::chrono::steady_clock::now() +
+            std::chrono::microseconds(uint64_t(bytes) * 1000000 / bench::i2cBytesPerSec);
+        while (std::chrono::steady_clock::now() < end) {}
+    }
+
+    void drawChar(int x, int y, uint16_t code) {
+        if (code == ' ') return;
+        for (int i = 0; i < 5; ++i) {
+            uint8_t column = (code * 37 + i * 11) & 0x7F;
+            for (int j = 0; j < 7; ++j) {
+                if (column & (1 << j)) drawPixel(x + i, y - 6 + j);
+            }
+        }
+    }
+
+public:
+    std::atomic<uint32_t> flushes{0};   // sendBuffer calls
+    std::atomic<uint64_t> busBytes{0};  // bytes sent over I2C
+
+    explicit U8G2_SSD1306_64X48_ER_F_HW_I2C(int) : buffer() {}
+
+    void begin() { clearDisplay(); }
+    void setPowerSave(int) { transfer(COMMAND_BUS_BYTES); }
+    void setContrast(uint8_t) { transfer(COMMAND_BUS_BYTES); }
+    void clearBuffer() { memset(buffer, 0, sizeof(buffer)); }
+    void clearDisplay() { clearBuffer(); sendBuffer(); }
+    void sendBuffer() {
+        ++flushes;
+        transfer(FRAME_BUS_BYTES);
+    }
+    uint8_t* getBufferPtr() { return buffer; }
+
+    void setFont(const uint8_t*) {}
+    void setDrawColor(int c) { color = c; }
+    void setCursor(int x, int y) { cursorX = x; cursorY = y; }
+
+    void drawPixel(int x, int y) {
+        x &= 0xFF; // coordinates are u8g2_uint_t, negative ones wrap and get clipped
+        y &= 0xFF;
+        if (x >= WIDTH || y >= HEIGHT) return;
+        uint8_t& b = buffer[(y / 8) * WIDTH + x];
+        if (color) {
+            b |= 1 << (y & 7);
+        } else {
+            b &= ~(1 << (y & 7));
+        }
+    }
+
+    void drawStr(int x, int y, const char* s) {
+        for (; *s; ++s, x += 5) drawChar(x, y, uint8_t(*s));
+    }
+
+    void drawGlyph(int x, int y, uint16_t code) { drawChar(x, y, code); }
+
+    void drawBox(int x, int y, int w, int h) {
+        for (int i = 0; i < w; ++i) {
+            for (int j = 0; j < h; ++j) drawPixel(x + i, y + j);
+        }
+    }
+
+    void drawFrame(int x, int y, int w, int h) {
+        for (int i = 0; i < w; ++i) { drawPixel(x + i, y); drawPixel(x + i, y + h - 1); }
+        for (int j = 0; j < h; ++j) { drawPixel(x, y + j); drawPixel(x + w - 1, y + j); }
+    }
+
+    void drawLine(int x0, int y0, int x1, int y1) {
+        int dx = x1 > x0 ? x1 - x0 : x0 - x1;
+        int dy = y1 > y0 ? y0 - y1 : y1 - y0;
+        int sx = x0 < x1 ? 1 : -1;
+        int sy = y0 < y1 ? 1 : -1;
+        int err = dx + dy;
+        for (;;) {
+            drawPixel(x0, y0);
+            if (x0 == x1 && y0 == y1) return;
+            int e2 = 2 * err;
+            if (e2 >= dy) { err += dy; x0 += sx; }
+            if (e2 <= dx) { err += dx; y0 += sy; }
+        }
+    }
+
+    void print(const char* s) {
+        drawStr(cursorX, cursorY, s);
+        cursorX += 5 * strlen(s);
+    }
+    // digits are written into a stack buffer like Arduino Print::printNumber does,
+    // no heap allocations that the device doesn't make either
+    template <class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+    void print(T value) {
+        char buf[24];
+        char* p = buf + sizeof(buf) - 1;
+        *p = 0;
+        bool negative = value < 0;
+        unsigned long long v = negative ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+        do {
+            *--p = '0' + v % 10;
+            v /= 10;
+        } while (v > 0);
+        if (negative) *--p = '-';
+        print(p);
+    }
+
+    void printf(const char* format, ...) {
+        char buf[64];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        print(buf);
+    }
+};
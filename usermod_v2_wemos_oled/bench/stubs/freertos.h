@@ -0,0 +1,35 @@
+#pragma once
+
+// FreeRTOS task API used by the render task, backed by std::thread.
+// Tasks are detached threads, notifications are counting semaphores.
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdPASS 1
+#define pdFAIL 0
+#define pdTRUE 1
+#define portMAX_DELAY 0xFFFFFFFF
+
+struct BenchTask {
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t notifications = 0;
+};
+typedef BenchTask* TaskHandle_t;
+
+namespace bench {
+    extern bool failTaskCreate;  // emulate out of memory, the usermod renders in `loop` then
+}
+
+// tasks run forever like on the device, so they are never freed
+BaseType_t xTaskCreatePinnedToCore(void (*fn)(void*), const char* name, uint32_t stack,
+    void* arg, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+BaseType_t xPortGetCoreID();
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, uint32_t ticks);
@@ -0,0 +1,128 @@
+// Definitions of the WLED, Arduino and FreeRTOS stand-ins declared in stubs/
+
+#include "wled.h"
+#include <U8g2lib.h>
+#include <ctime>
+
+namespace bench {
+    uint32_t now = 0;
+    uint32_t epoch = 1700000000;
+    bool buttons[2] = { false, false };
+    uint32_t stateUpdates = 0;
+    uint32_t notifications = 0;
+    uint32_t i2cBytesPerSec = 0;
+#ifdef ARDUINO_ARCH_ESP32
+    bool failTaskCreate = false;
+#endif
+}
+
+NetworkClass Network;
+WiFiClass WiFi;
+EspClass ESP;
+FileSystem WLED_FS;
+Strip strip;
+
+static uint32_t randomState = 12345;
+
+static uint32_t nextRandom() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+uint32_t esp_random() { return nextRandom(); }
+#else
+uint32_t EspClass::random() const { return nextRandom(); }
+#endif
+
+WLED& WLED::instance() {
+    static WLED wled;
+    return wled;
+}
+
+byte bri = 128, effectCurrent = 0, effectSpeed = 128, effectIntensity = 128, currentPreset = 0;
+int16_t currentPlaylist = -1;
+bool stateChanged = false, doReboot = false, apActive = false;
+char apSSID[33] = "WLED-AP", apPass[65] = "wled1234", versionString[] = "0.14.0";
+byte col[4] = { 255, 160, 0, 0 };
+uint32_t rolloverMillis = 0;
+size_t fsBytesUsed = 40000, fsBytesTotal = 1000000;
+unsigned long localTime = 0;
+
+// WLED copies globals to segments in `colorUpdated` and reloads them in `stateUpdated`
+void stateUpdated(byte callMode) {
+    effectCurrent = strip.getMainSegment().mode;
+    ++bench::stateUpdates;
+    if (callMode != CALL_MODE_NO_NOTIFY) ++bench::notifications;
+    stateChanged = true;
+}
+
+void colorUpdated(byte callMode) {
+    strip.getMainSegment().mode = effectCurrent;
+    stateUpdated(callMode);
+}
+
+void toggleOnOff() { bri = bri > 0 ? 0 : 128; }
+void setRandomColor(byte* rgb) { rgb[0] = nextRandom(); rgb[1] = nextRandom(); rgb[2] = nextRandom(); }
+void updateLocalTime() { localTime = bench::epoch + ((uint64_t(rolloverMillis) << 32) | bench::now) / 1000; }
+int getSignalQuality(int rssi) { return rssi <= -100 ? 0 : rssi >= -50 ? 100 : 2 * (rssi + 100); }
+bool isButtonPressed(uint8_t b) { return b < 2 && bench::buttons[b]; }
+
+static struct tm toTm(unsigned long t) {
+    time_t tt = t;
+    struct tm result;
+    gmtime_r(&tt, &result);
+    return result;
+}
+
+int hour(unsigned long t) { return toTm(t).tm_hour; }
+int minute(unsigned long t) { return toTm(t).tm_min; }
+int second(unsigned long t) { return toTm(t).tm_sec; }
+int day(unsigned long t) { return toTm(t).tm_mday; }
+int month(unsigned long t) { return toTm(t).tm_mon + 1; }
+int year(unsigned long t) { return toTm(t).tm_year + 1900; }
+int weekday(unsigned long t) { return toTm(t).tm_wday + 1; }
+
+void oappend(const char*) {}
+
+const uint8_t u8g2_font_profont10_tr[1] = {}, u8g2_font_profont10_tn[1] = {},
+    u8g2_font_profont17_mn[1] = {}, u8g2_font_profont22_tn[1] = {},
+    u8g2_font_open_iconic_all_1x_t[1] = {}, u8g2_font_open_iconic_embedded_4x_t[1] = {},
+    u8g2_font_open_iconic_www_4x_t[1] = {}, u8g2_font_open_iconic_thing_4x_t[1] = {},
+    u8g2_font_open_iconic_play_4x_t[1] = {}, u8g2_font_open_iconic_text_4x_t[1] = {},
+    u8g2_font_open_iconic_mime_4x_t[1] = {}, u8g2_font_open_iconic_gui_4x_t[1] = {};
+
+#ifdef ARDUINO_ARCH_ESP32
+static thread_local BenchTask* currentTask = nullptr;
+
+BaseType_t xTaskCreatePinnedToCore(void (*fn)(void*), const char*, uint32_t,
+        void* arg, UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    if (bench::failTaskCreate) return pdFAIL;
+    BenchTask* task = new BenchTask();
+    *handle = task;
+    std::thread([fn, arg, task]() {
+        currentTask = task;
+        fn(arg);
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xPortGetCoreID() { return 1; }
+
+void xTaskNotifyGive(TaskHandle_t task) {
+    std::lock_guard<std::mutex> lock(task->mutex);
+    ++task->notifications;
+    task->cv.notify_one();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, uint32_t) {
+    BenchTask* task = currentTask;
+    std::unique_lock<std::mutex> lock(task->mutex);
+    task->cv.wait(lock, [task]() { return task->notifications > 0; });
+    uint32_t count = task->notifications;
+    task->notifications = clearOnExit ? 0 : count - 1;
+    return count;
+}
+#endif
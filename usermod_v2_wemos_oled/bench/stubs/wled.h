@@ -0,0 +1,232 @@
+#pragma once
+
+// Minimal WLED and Arduino stand-ins to build wemos_oled.h on the host.
+// Time is virtual: benchmarks set `bench::now` and `millis()` returns it.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+
+#ifdef ARDUINO_ARCH_ESP32
+#include "freertos.h"
+#endif
+
+#define F(x) x
+#define SET_F(x) x
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define CALL_MODE_BUTTON 2
+#define CALL_MODE_NO_NOTIFY 5
+#define USERMOD_ID_WEMOS_OLED 100
+#define WLED_MAX_SEGMENTS 16
+#define VERSION 2310130
+
+namespace bench {
+    extern uint32_t now;              // virtual millis()
+    extern uint32_t epoch;            // local time at now == 0, s
+    extern bool buttons[2];           // pressed buttons
+    extern uint32_t stateUpdates;     // stateUpdated calls
+    extern uint32_t notifications;    // stateUpdated calls that notify other devices
+}
+
+// 32 bit like on the device
+inline uint32_t millis() { return bench::now; }
+inline void yield() {}
+
+// Arduino stdlib_noniso
+inline char* ltoa(long value, char* buf, int base) {
+    char digits[24];
+    int n = 0;
+    unsigned long v = value < 0 ? 0UL - value : value;
+    do {
+        digits[n++] = "0123456789abcdef"[v % base];
+        v /= base;
+    } while (v > 0);
+    char* p = buf;
+    if (value < 0) *p++ = '-';
+    while (n > 0) *p++ = digits[--n];
+    *p = 0;
+    return buf;
+}
+
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = min(len, size - 1);
+        memcpy(dst, src, n);
+        dst[n] = 0;
+    }
+    return len;
+}
+
+struct String {
+    std::string s;
+    String(const char* c = "") : s(c) {}
+    const char* c_str() const { return s.c_str(); }
+};
+
+struct IPAddress {
+    uint8_t octets[4];
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%d.%d.%d.%d", octets[0], octets[1], octets[2], octets[3]);
+        return String(buf);
+    }
+};
+
+struct NetworkClass {
+    IPAddress ip = {{192, 168, 1, 42}};
+    IPAddress localIP() const { return ip; }
+};
+extern NetworkClass Network;
+
+struct WiFiClass {
+    std::string ssid = "bench-network";
+    int rssi = -60;
+    String SSID() const { return String(ssid.c_str()); }
+    int RSSI() const { return rssi; }
+};
+extern WiFiClass WiFi;
+
+#ifdef ARDUINO_ARCH_ESP32
+struct EspClass {
+    uint32_t getFreeHeap() const { return 180000; }
+    uint32_t getHeapSize() const { return 320000; }
+    uint32_t getSketchSize() const { return 1200000; }
+    uint32_t getFreeSketchSpace() const { return 1900000; }
+    const char* getSdkVersion() const { return "v4.4.7"; }
+    uint64_t getEfuseMac() const { return 0xA1B2C3D4E5F6ULL; }
+};
+uint32_t esp_random();
+#else
+struct EspClass {
+    uint32_t random() const;
+    uint32_t getFreeHeap() const { return 30000; }
+    uint32_t getSketchSize() const { return 700000; }
+    uint32_t getFreeSketchSpace() const { return 1000000; }
+    String getCoreVersion() const { return String("3.1.2"); }
+    uint32_t getChipId() const { return 0xC3D4E5; }
+};
+#endif
+extern EspClass ESP;
+
+// file system serving files from memory
+struct File {
+    const std::vector<uint8_t>* data = nullptr;
+    size_t pos = 0;
+    size_t size() const { return data ? data->size() : 0; }
+    size_t read(uint8_t* buf, size_t len) {
+        len = min(len, size() - pos);
+        if (len > 0) memcpy(buf, data->data() + pos, len);
+        pos += len;
+        return len;
+    }
+    void close() { data = nullptr; }
+    explicit operator bool() const { return data != nullptr; }
+};
+
+struct FileSystem {
+    std::string name;
+    std::vector<uint8_t> content;  // single file is enough for the usermod
+    bool exists(const char* path) const { return name == path; }
+    File open(const char* path, const char*) const {
+        File f;
+        if (exists(path)) f.data = &content;
+        return f;
+    }
+    bool format() { name.clear(); content.clear(); return true; }
+};
+extern FileSystem WLED_FS;
+
+struct Segment {
+    bool active;
+    bool on;
+    uint8_t mode;
+    uint8_t palette;
+    uint8_t opacity;
+    uint16_t start;
+    uint16_t stop;
+    Segment(uint16_t start = 0, uint16_t stop = 0)
+        : active(true), on(true), mode(0), palette(0), opacity(255), start(start), stop(stop) {}
+    bool isActive() const { return active && stop > start; }
+    uint16_t length() const { return stop - start; }
+};
+
+struct Strip {
+    std::vector<Segment> segments = std::vector<Segment>(1, Segment(0, 60));
+    uint32_t currentMilliamps = 420;
+    uint32_t ablMilliampsMax = 850;
+    bool isUpdating() const { return false; }
+    uint16_t getLengthTotal() const { return segments.empty() ? 0 : segments.back().stop; }
+    uint16_t getFps() const { return 42; }
+    uint8_t getModeCount() const { return 187; }
+    uint8_t getSegmentsNum() const { return segments.size(); }
+    Segment& getSegment(uint8_t id) { return segments[id < segments.size() ? id : 0]; }
+    Segment& getMainSegment() { return segments[0]; }
+};
+extern Strip strip;
+
+struct WLED {
+    static WLED& instance();
+    void initAP(bool) {}
+};
+
+extern byte bri, effectCurrent, effectSpeed, effectIntensity, currentPreset;
+extern int16_t currentPlaylist;
+extern bool stateChanged, doReboot, apActive;
+extern char apSSID[33], apPass[65], versionString[];
+extern byte col[4];
+extern uint32_t rolloverMillis;
+extern size_t fsBytesUsed, fsBytesTotal;
+extern unsigned long localTime;
+#define WLED_CONNECTED (!apActive)
+
+void stateUpdated(byte callMode);
+void colorUpdated(byte callMode);
+void toggleOnOff();
+void setRandomColor(byte* rgb);
+void updateLocalTime();
+int getSignalQuality(int rssi);
+bool isButtonPressed(uint8_t b);
+int hour(unsigned long t);
+int minute(unsigned long t);
+int second(unsigned long t);
+int day(unsigned long t);
+int month(unsigned long t);
+int year(unsigned long t);
+int weekday(unsigned long t);
+
+// enough of ArduinoJson for settings: every key is missing, so defaults are kept
+struct JsonArray {
+    template <class T> void add(T) {}
+};
+struct JsonObject;
+struct JsonVariant {
+    operator JsonObject() const;
+    template <class T> T operator|(T value) const { return value; }
+    template <class T> JsonVariant& operator=(T) { return *this; }
+};
+struct JsonObject {
+    JsonVariant operator[](const char*) const { return {}; }
+    bool isNull() const { return false; }
+    JsonObject createNestedObject(const char*) { return {}; }
+    JsonArray createNestedArray(const char*) { return {}; }
+};
+inline JsonVariant::operator JsonObject() const { return {}; }
+
+void oappend(const char* text);
+
+class Usermod {
+public:
+    virtual ~Usermod() {}
+};
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""Compile Wemos OLED user-defined screens into the layout file.
+
+Source is a plain text file, one instruction per line, `#` starts a comment:
+
+    screen                  # starts a new screen (up to 4)
+    font profont10          # profont10 (default), profont10_num, profont17_num, profont22_num, icons
+    text 0 17 "BRI:"        # x y (baseline) text
+    var 25 17 bri           # x y variable
+    glyph 1 8 259           # x y glyph code in current font
+    frame 0 0 64 48         # x y w h
+    box 0 0 64 9            # x y w h
+    line 0 9 63 9           # x0 y0 x1 y1
+
+Variables: state, bri, leds, power, fps, preset, playlist, effect, palette,
+speed, intensity, ssid, ip, signal, time, seconds, date, weekday, uptime.
+
+Usage:
+    python3 oled_layout.py screens.txt wemos_oled.bin
+
+Upload the result to the WLED file system (http://<wled-ip>/edit) as
+/wemos_oled.bin and reboot. Screens follow ABOUT in info screens rotation.
+"""
+
+import shlex
+import struct
+import sys
+
+VERSION = 1
+MAX_SIZE = 512
+MAX_SCREENS = 4
+
+OP_END, OP_FONT, OP_TEXT, OP_VAR, OP_GLYPH, OP_FRAME, OP_BOX, OP_LINE = range(8)
+
+FONTS = ['profont10', 'profont10_num', 'profont17_num', 'profont22_num', 'icons']
+
+VARS = [
+    'state', 'bri', 'leds', 'power', 'fps',
+    'preset', 'playlist', 'effect', 'palette', 'speed', 'intensity',
+    'ssid', 'ip', 'signal',
+    'time', 'seconds', 'date', 'weekday',
+    'uptime',
+]
+
+# instruction: opcode and number of byte arguments
+SHAPES = {
+    'frame': (OP_FRAME, 4),
+    'box': (OP_BOX, 4),
+    'line': (OP_LINE, 4),
+}
+
+
+class LayoutError(Exception):
+    pass
+
+
+def byte(value):
+    n = int(value, 0)
+    if not 0 <= n <= 255:
+        raise LayoutError('value out of range 0..255: %s' % value)
+    return n
+
+
+def compile_line(args):
+    cmd = args[0]
+    if cmd == 'font':
+        if len(args) != 2 or args[1] not in FONTS:
+            raise LayoutError('font expects one of: ' + ', '.join(FONTS))
+        return bytes([OP_FONT, FONTS.index(args[1])])
+    if cmd == 'text':
+        if len(args) != 4:
+            raise LayoutError('text expects x y "text"')
+        text = args[3].encode('ascii')
+        if len(text) > 255 or b'\0' in text:
+            raise LayoutError('bad text')
+        return bytes([OP_TEXT, byte(args[1]), byte(args[2]), len(text)]) + text + b'\0'
+    if cmd == 'var':
+        if len(args) != 4 or args[3] not in VARS:
+            raise LayoutError('var expects x y and one of: ' + ', '.join(VARS))
+        return bytes([OP_VAR, byte(args[1]), byte(args[2]), VARS.index(args[3])])
+    if cmd == 'glyph':
+        if len(args) != 4:
+            raise LayoutError('glyph expects x y code')
+        code = int(args[3], 0)
+        if not 0 <= code <= 0xFFFF:
+            raise LayoutError('glyph code out of range')
+        return bytes([OP_GLYPH, byte(args[1]), byte(args[2]), code & 0xFF, code >> 8])
+    if cmd in SHAPES:
+        op, argc = SHAPES[cmd]
+        if len(args) != argc + 1:
+            raise LayoutError('%s expects %d numbers' % (cmd, argc))
+        return bytes([op] + [byte(a) for a in args[1:]])
+    raise LayoutError('unknown instruction: ' + cmd)
+
+
+def compile_layout(source):
+    screens = []
+    for lineno, line in enumerate(source.splitlines(), 1):
+        try:
+            args = shlex.split(line, comments=True)
+            if not args:
+                continue
+            if args[0] == 'screen':
+                screens.append(bytearray())
+                continue
+            if not screens:
+                raise LayoutError('instruction outside of screen')
+            screens[-1] += compile_line(args)
+        except (LayoutError, ValueError) as e:
+            raise LayoutError('line %d: %s' % (lineno, e))
+
+    if not 0 < len(screens) <= MAX_SCREENS:
+        raise LayoutError('expected 1..%d screens' % MAX_SCREENS)
+
+    header = bytearray(b'WO') + bytes([VERSION, len(screens)])
+    offset = len(header) + 2 * len(screens)
+    body = bytearray()
+    for screen in screens:
+        header += struct.pack('<H', offset + len(body))
+        body += screen + bytes([OP_END])
+    data = bytes(header + body)
+    if len(data) > MAX_SIZE:
+        raise LayoutError('layout is %d bytes, max is %d' % (len(data), MAX_SIZE))
+    return data
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        return 1
+    with open(sys.argv[1]) as f:
+        source = f.read()
+    try:
+        data = compile_layout(source)
+    except LayoutError as e:
+        print('error: %s' % e, file=sys.stderr)
+        return 1
+    with open(sys.argv[2], 'wb') as f:
+        f.write(data)
+    print('%s: %d bytes' % (sys.argv[2], len(data)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""Build WLED with several Wemos OLED usermod configurations and report firmware sizes.
+
+Usage:
+    python3 size_report.py WLED_ROOT ENV
+
+WLED_ROOT must have the usermod registered (see README). Every configuration
+is built with `pio run` and extra flags from PLATFORMIO_BUILD_FLAGS.
+Subset fonts are generated by subset_fonts.py before each build that needs them.
+"""
+
+import os
+import subprocess
+import sys
+
+import subset_fonts
+
+# name, dropped screens, other flags, subset fonts
+CONFIGS = [
+    ('full', [], [], False),
+    ('subset fonts', [], [], True),
+    ('no custom screens', [], ['NO_CUSTOM_SCREENS'], True),
+    ('no screensavers', [], ['NO_CUSTOM_SCREENS', 'NO_NIGHTSKY', 'NO_CLOCK_SCREENSAVER'], True),
+    ('minimal', ['fx', 'tech', 'time', 'display', 'about'],
+        ['NO_CUSTOM_SCREENS', 'NO_SEGMENTS_SCREEN', 'NO_NIGHTSKY', 'NO_CLOCK_SCREENSAVER'], True),
+]
+
+SCREEN_FLAGS = {
+    'led': 'NO_LED_SCREEN',
+    'fx': 'NO_FX_SCREEN',
+    'tech': 'NO_TECH_SCREEN',
+    'time': 'NO_TIME_SCREEN',
+    'display': 'NO_DISPLAY_SCREEN',
+    'about': 'NO_ABOUT_SCREEN',
+}
+
+
+def build(wled_root, env, flags):
+    environ = dict(os.environ)
+    environ['PLATFORMIO_BUILD_FLAGS'] = ' '.join('-D WEMOS_OLED_' + f for f in flags)
+    subprocess.run(['pio', 'run', '-s', '-d', wled_root, '-e', env], env=environ, check=True)
+    return os.path.getsize(os.path.join(wled_root, '.pio', 'build', env, 'firmware.bin'))
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        return 1
+    wled_root, env = sys.argv[1], sys.argv[2]
+    here = os.path.dirname(os.path.abspath(__file__))
+    fonts_header = os.path.join(here, '..', 'wemos_oled_fonts.h')
+    u8g2 = os.path.join(wled_root, '.pio', 'libdeps', env, 'U8g2')
+
+    results = []
+    for name, drop, flags, subset in CONFIGS:
+        flags = flags + [SCREEN_FLAGS[s] for s in drop]
+        if subset:
+            # libdeps are installed by the first (full) build
+            text, _ = subset_fonts.generate(u8g2, drop)
+            with open(fonts_header, 'w') as f:
+                f.write(text)
+            flags.append('SUBSET_FONTS')
+        results.append((name, build(wled_root, env, flags)))
+
+    base = results[0][1]
+    print('%-20s %10s %8s' % ('configuration', 'bytes', 'delta'))
+    for name, size in results:
+        print('%-20s %10d %+8d' % (name, size, size - base))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
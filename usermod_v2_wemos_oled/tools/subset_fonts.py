@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+"""Generate wemos_oled_fonts.h with icon fonts reduced to used glyphs.
+
+Fonts are taken from u8g2_fonts.c of the installed U8g2 library and
+subsetted in their compiled form, so no BDF sources are needed.
+
+Usage:
+    python3 subset_fonts.py --u8g2 WLED_ROOT/.pio/libdeps/ENV/U8g2 \\
+        [--drop led,fx,tech,time,display,about] [--icons 64,65] \\
+        [-o ../wemos_oled_fonts.h]
+
+Then build with `-D WEMOS_OLED_SUBSET_FONTS`. `--drop` should match
+WEMOS_OLED_NO_*_SCREEN build flags. Custom screens can draw only icons
+kept in the subset, add them with `--icons`.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HEADER_SIZE = 23
+
+# glyphs drawn by wemos_oled.h, keep in sync with `drawIcons`, `drawMenuItem` and `drawSplash`
+SCREEN_ICONS = {
+    'wifi': 248,
+    'led': 259,
+    'fx': 211,
+    'tech': 129,
+    'time': 123,
+    'display': 222,
+    'about': 188,
+}
+
+FONTS = [
+    # macro, u8g2 font, glyphs
+    ('WO_FONT_ICONS', 'u8g2_font_open_iconic_all_1x_t', None),  # screen icons
+    ('WO_FONT_EMBEDDED', 'u8g2_font_open_iconic_embedded_4x_t', [71, 78, 79]),
+    ('WO_FONT_WWW', 'u8g2_font_open_iconic_www_4x_t', [72, 81]),
+    ('WO_FONT_THING', 'u8g2_font_open_iconic_thing_4x_t', [71]),
+    ('WO_FONT_PLAY', 'u8g2_font_open_iconic_play_4x_t', [72]),
+    ('WO_FONT_TEXT', 'u8g2_font_open_iconic_text_4x_t', [87, 88]),
+    ('WO_FONT_MIME', 'u8g2_font_open_iconic_mime_4x_t', [68]),
+    ('WO_FONT_GUI', 'u8g2_font_open_iconic_gui_4x_t', [65]),
+]
+
+ESCAPES = {'n': 10, 't': 9, 'r': 13, 'a': 7, 'b': 8, 'f': 12, 'v': 11,
+           '\\': 92, '"': 34, "'": 39, '?': 63}
+
+
+class FontError(Exception):
+    pass
+
+
+def find_fonts_source(path):
+    if os.path.isfile(path):
+        return path
+    for root, _, files in os.walk(path):
+        if 'u8g2_fonts.c' in files:
+            return os.path.join(root, 'u8g2_fonts.c')
+    raise FontError('u8g2_fonts.c not found in ' + path)
+
+
+def decode_c_string(literal):
+    data = bytearray()
+    i = 0
+    while i < len(literal):
+        c = literal[i]
+        if c != '\\':
+            data.append(ord(c))
+            i += 1
+            continue
+        c = literal[i + 1]
+        if c in '01234567':
+            j = i + 1
+            while j < len(literal) and j < i + 4 and literal[j] in '01234567':
+                j += 1
+            data.append(int(literal[i + 1:j], 8))
+            i = j
+        elif c == 'x':
+            j = i + 2
+            while j < len(literal) and literal[j] in '0123456789abcdefABCDEF':
+                j += 1
+            data.append(int(literal[i + 2:j], 16) & 0xFF)
+            i = j
+        else:
+            data.append(ESCAPES[c])
+            i += 2
+    return bytes(data)
+
+
+def read_font(source, name):
+    m = re.search(r'const\s+uint8_t\s+' + name + r'\[(\d+)\][^=]*=\s*((?:"(?:[^"\\]|\\.)*"\s*)+);', source)
+    if m is None:
+        raise FontError(name + ' not found')
+    data = decode_c_string(''.join(re.findall(r'"((?:[^"\\]|\\.)*)"', m.group(2))))
+    if len(data) + 1 != int(m.group(1)):
+        raise FontError('%s: size mismatch' % name)
+    return data
+
+
+def word(font, pos):
+    return (font[pos] << 8) | font[pos + 1]
+
+
+def lookup(font, encoding):
+    """Glyph record lookup, the same as u8g2_font_get_glyph_data"""
+    pos = HEADER_SIZE
+    if encoding <= 255:
+        if encoding >= ord('a'):
+            pos += word(font, 19)
+        elif encoding >= ord('A'):
+            pos += word(font, 17)
+        while font[pos + 1] != 0:
+            if font[pos] == encoding:
+                return font[pos + 2:pos + font[pos + 1]]
+            pos += font[pos + 1]
+        return None
+    pos += word(font, 21)
+    table = pos
+    while True:
+        pos += word(font, table)
+        e = word(font, table + 2)
+        table += 4
+        if e >= encoding:
+            break
+    while word(font, pos) != 0:
+        if word(font, pos) == encoding:
+            return font[pos + 3:pos + font[pos + 2]]
+        pos += font[pos + 2]
+    return None
+
+
+def parse_glyphs(font, name):
+    glyphs = {}
+    pos = HEADER_SIZE
+    while font[pos + 1] != 0:
+        glyphs[font[pos]] = font[pos + 2:pos + font[pos + 1]]
+        pos += font[pos + 1]
+    end8 = pos + 2
+    table = HEADER_SIZE + word(font, 21)
+    if table >= end8 and word(font, table) > 0:
+        pos = table + word(font, table)
+        while word(font, pos) != 0:
+            glyphs[word(font, pos)] = font[pos + 3:pos + font[pos + 2]]
+            pos += font[pos + 2]
+    if len(glyphs) % 256 != font[0]:
+        raise FontError('%s: parsed %d glyphs, header says %d' % (name, len(glyphs), font[0]))
+    for encoding, data in glyphs.items():
+        if lookup(font, encoding) != data:
+            raise FontError('%s: unexpected layout of glyph %d' % (name, encoding))
+    return glyphs
+
+
+def build_subset(font, glyphs, keep):
+    body = bytearray()
+    upper_a = lower_a = None
+    for encoding in sorted(e for e in keep if e <= 255):
+        if upper_a is None and encoding >= ord('A'):
+            upper_a = len(body)
+        if lower_a is None and encoding >= ord('a'):
+            lower_a = len(body)
+        body += bytes([encoding, len(glyphs[encoding]) + 2]) + glyphs[encoding]
+    end8 = len(body)
+    body += b'\0\0'
+
+    unicode_pos = len(body)
+    records = bytearray()
+    wide = sorted(e for e in keep if e > 255)
+    for encoding in wide:
+        records += bytes([encoding >> 8, encoding & 0xFF, len(glyphs[encoding]) + 3]) + glyphs[encoding]
+    if wide:
+        # single group: offset to records and last encoding, then offset to terminator
+        body += bytes([0, 8, wide[-1] >> 8, wide[-1] & 0xFF])
+        body += bytes([len(records) >> 8, len(records) & 0xFF, 0xFF, 0xFF])
+    else:
+        body += bytes([0, 4, 0xFF, 0xFF])
+    body += records + b'\0\0'
+
+    header = bytearray(font[:HEADER_SIZE])
+    header[0] = len(keep) & 0xFF
+    for offset, value in ((17, upper_a), (19, lower_a), (21, unicode_pos)):
+        value = end8 if value is None else value
+        header[offset:offset + 2] = bytes([value >> 8, value & 0xFF])
+    return bytes(header + body)
+
+
+def subset_font(font, name, keep):
+    glyphs = parse_glyphs(font, name)
+    missing = [e for e in keep if e not in glyphs]
+    if missing:
+        raise FontError('%s: no glyphs %s' % (name, missing))
+    subset = build_subset(font, glyphs, keep)
+    for encoding in glyphs:
+        expected = glyphs[encoding] if encoding in keep else None
+        if lookup(subset, encoding) != expected:
+            raise FontError('%s: subset check failed for glyph %d' % (name, encoding))
+    return subset
+
+
+def generate(u8g2_path, drop=(), icons=()):
+    with open(find_fonts_source(u8g2_path)) as f:
+        source = f.read()
+    lines = [
+        '// generated by tools/subset_fonts.py, do not edit',
+        '// dropped screens: %s' % (', '.join(drop) or 'none'),
+        '#pragma once',
+        '',
+    ]
+    sizes = []
+    for macro, name, keep in FONTS:
+        if keep is None:
+            keep = [code for screen, code in SCREEN_ICONS.items() if screen not in drop]
+            keep += icons
+        keep = sorted(set(keep))
+        font = read_font(source, name)
+        subset = subset_font(font, name, keep)
+        sizes.append((name, len(font), len(subset)))
+        array = 'wo_' + name[len('u8g2_'):]
+        lines.append('static const uint8_t %s[%d] U8G2_FONT_SECTION("%s") = {' % (array, len(subset), array))
+        for i in range(0, len(subset), 16):
+            lines.append('    ' + ' '.join('0x%02x,' % b for b in subset[i:i + 16]))
+        lines.append('};')
+        lines.append('#define %s %s' % (macro, array))
+        lines.append('')
+    return '\n'.join(lines), sizes
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description='Generate subset icon fonts for Wemos OLED usermod')
+    parser.add_argument('--u8g2', required=True, help='U8g2 library directory or u8g2_fonts.c')
+    parser.add_argument('--drop', default='', help='screens dropped from build: ' + ', '.join(SCREEN_ICONS))
+    parser.add_argument('--icons', default='', help='extra icon glyphs used by custom screens')
+    parser.add_argument('-o', '--output', default=os.path.join(here, '..', 'wemos_oled_fonts.h'))
+    args = parser.parse_args()
+
+    drop = [s for s in args.drop.split(',') if s]
+    unknown = [s for s in drop if s not in SCREEN_ICONS or s == 'wifi']
+    if unknown:
+        parser.error('unknown screens: ' + ', '.join(unknown))
+    icons = [int(g, 0) for g in args.icons.split(',') if g]
+    try:
+        text, sizes = generate(args.u8g2, drop, icons)
+    except FontError as e:
+        print('error: %s' % e, file=sys.stderr)
+        return 1
+    with open(args.output, 'w') as f:
+        f.write(text)
+    for name, full, subset in sizes:
+        print('%-40s %6d -> %5d bytes' % (name, full, subset))
+    print('total: %d -> %d bytes' % (sum(s[1] for s in sizes), sum(s[2] for s in sizes)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
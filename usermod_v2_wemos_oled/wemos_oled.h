@@ -3,6 +3,35 @@
 #include "wled.h"
 #include <U8g2lib.h>
 
+/*
+    Build flags to save flash:
+    - WEMOS_OLED_NO_LED_SCREEN, WEMOS_OLED_NO_FX_SCREEN, WEMOS_OLED_NO_TECH_SCREEN,
+      WEMOS_OLED_NO_TIME_SCREEN, WEMOS_OLED_NO_DISPLAY_SCREEN, WEMOS_OLED_NO_ABOUT_SCREEN,
+      WEMOS_OLED_NO_SEGMENTS_SCREEN: drop info screen
+    - WEMOS_OLED_NO_NIGHTSKY, WEMOS_OLED_NO_CLOCK_SCREENSAVER: drop screensaver
+    - WEMOS_OLED_NO_CUSTOM_SCREENS: drop user-defined screens,
+      fonts referenced by layouts only are dropped too
+    - WEMOS_OLED_SUBSET_FONTS: use icon fonts generated by tools/subset_fonts.py
+*/
+#ifdef WEMOS_OLED_SUBSET_FONTS
+#include "wemos_oled_fonts.h"
+#else
+#define WO_FONT_ICONS u8g2_font_open_iconic_all_1x_t
+#define WO_FONT_EMBEDDED u8g2_font_open_iconic_embedded_4x_t
+#define WO_FONT_WWW u8g2_font_open_iconic_www_4x_t
+#define WO_FONT_THING u8g2_font_open_iconic_thing_4x_t
+#define WO_FONT_PLAY u8g2_font_open_iconic_play_4x_t
+#define WO_FONT_TEXT u8g2_font_open_iconic_text_4x_t
+#define WO_FONT_MIME u8g2_font_open_iconic_mime_4x_t
+#define WO_FONT_GUI u8g2_font_open_iconic_gui_4x_t
+#endif
+
+// render and flush frames in a separate task on the other core
+#if defined(ARDUINO_ARCH_ESP32) && defined(WEMOS_OLED_RENDER_TASK)
+#define WO_RENDER_TASK
+#include <atomic>
+#endif
+
 /*
     Display vertical layout:
     - Info screens:
@@ -14,19 +43,76 @@
         29..37: third text line
         38: blank
         39..47: fourth text line
+    - Segments screen: page header in line 0..8, then the same text lines
     - Splash and menu screens:
         0..35 picture
         39..47 caption
 */
 
 class WemosOledUsermod : public Usermod {
+#ifdef WEMOS_OLED_BENCH
+    friend struct WemosOledBench; // host benchmarks, see bench/
+#endif
 private:
     using WO = WemosOledUsermod;
 
-    static constexpr unsigned long BTN_TIMEOUT = 350;            // button debounce timeout
-    static constexpr unsigned long MENU_EXIT_TIMEOUT = 30000;    // quit menu after 30 sec of inactivity
-    static constexpr unsigned long SCREENSAVER_TIMEOUT = 120000; // enable screensaver mode after 2 min of inactivity
-    static constexpr unsigned long HIGHLIGHT_TIMEOUT = 10000;    // set min contrast after 10 sec of inactivity
+    // defaults for configurable timeouts and update rates
+    static constexpr uint32_t BTN_TIMEOUT = 350;            // button debounce timeout
+    static constexpr uint32_t MENU_EXIT_TIMEOUT = 30000;    // quit menu after 30 sec of inactivity
+    static constexpr uint32_t SCREENSAVER_TIMEOUT = 120000; // enable screensaver mode after 2 min of inactivity
+    static constexpr uint32_t HIGHLIGHT_TIMEOUT = 10000;    // set min contrast after 10 sec of inactivity
+    static constexpr uint32_t CLOCK_RATE = 1000;            // time screen and screensavers
+    static constexpr uint32_t LED_RATE = 3000;              // led and fx screens
+    static constexpr uint32_t INFO_RATE = 10000;            // other info screens
+    static constexpr uint32_t ABOUT_RATE = 30000;           // about screen
+    static constexpr uint32_t SPLASH_RATE = 500;            // splash animation, not configurable
+    static constexpr uint32_t SEGMENT_PAGE_RATE = 3000;     // show next segment after this period
+    static constexpr uint32_t MIN_TIMEOUT = 5000;           // shorter inactivity timeouts make screens unusable
+    static constexpr uint32_t MAX_TIMEOUT = 86400000;       // 1 day, longer periods may alias on millis() rollover
+    static constexpr uint32_t MIN_BTN_TIMEOUT = 20;         // shorter debounce repeats action while button is held
+    static constexpr uint32_t MAX_BTN_TIMEOUT = 2000;       // longer debounce makes buttons look dead
+
+    static constexpr uint32_t REPEAT_DELAY = 500;        // hold action button this long to start auto-repeat
+    static constexpr uint32_t REPEAT_RATE = 100;         // auto-repeat period
+    static constexpr uint32_t STATE_UPDATE_DELAY = 750;  // publish state changes after this quiet period
+
+    // I2C traffic estimates used by the bandwidth governor
+    static constexpr uint16_t FRAME_BYTES = 440;  // full frame: 384 data bytes plus addressing and control bytes
+    static constexpr uint16_t COMMAND_BYTES = 4;  // single display command (contrast, power save)
+    static constexpr uint32_t MAX_BUDGET_PERIOD = 10000;      // cap of budget refill period, ms
+
+    static constexpr uint32_t CONTRAST_FADE_STEP = 30;           // delay between contrast fade steps
+    static constexpr uint8_t CONTRAST_FADE_STEPS = 4;            // contrast commands sent per fade
+    static constexpr uint32_t PIXEL_SHIFT_PERIOD = 300000;       // shift image by a pixel every 5 min
+
+    static constexpr uint8_t PANEL_WIDTH = 64;
+    static constexpr uint8_t PANEL_PAGES = 6;                // 48 rows, 8 rows per page
+    static constexpr uint16_t FRAME_SIZE = WO::PANEL_WIDTH * WO::PANEL_PAGES; // frame buffer size
+    static constexpr uint16_t ADAPTIVE_LIT_LIMIT = 384;      // lit pixels allowed at full contrast (1/8 of panel)
+    static constexpr uint32_t PIXEL_CURRENT_NA = 2500;       // rough per-pixel current at max contrast, nA
+
+    // pixel shift orbit, every position clips at most one row and one column
+    static constexpr uint8_t SHIFT_X[4] = { 0, 1, 1, 0 };
+    static constexpr uint8_t SHIFT_Y[4] = { 0, 0, 1, 1 };
+
+    // user-defined screens, see tools/oled_layout.py
+    static constexpr const char* LAYOUT_FILE = "/wemos_oled.bin";
+    static constexpr uint8_t LAYOUT_VERSION = 1;
+    static constexpr uint16_t LAYOUT_SIZE = 512;  // max layout file size
+    static constexpr uint8_t MAX_LAYOUTS = 4;
+
+    static constexpr uint8_t MAX_SEGMENTS = WLED_MAX_SEGMENTS; // segments cached by segments screen
+
+    // top bar icons of info screens
+    static constexpr uint16_t SCREEN_ICON[7] = {
+        248, // wifi
+        259, // sun
+        211, // play
+        129, // tech
+        123, // clock
+        222, // display
+        188  // info
+    };
 
     static constexpr const char* DAY_NAME[7] = {
         "SUNDAY", "MONDAY", "TUESDAY",
@@ -48,6 +134,8 @@ private:
         TIME_AND_DATE = 4,
         DISPLAY_INFO = 5,
         ABOUT = 6,
+        CUSTOM = 7,
+        SEGMENTS = 8,
         MENU_POWER = 127,
         MENU_COLOR = 128,
         MENU_AP = 129,
@@ -65,16 +153,231 @@ private:
         SPLASH = 255
     };
 
+    // layout bytecode instructions, all arguments are single bytes
+    enum LayoutOp : uint8_t {
+        OP_END = 0,   // end of screen
+        OP_FONT = 1,  // font index in LAYOUT_FONTS
+        OP_TEXT = 2,  // x, y, length, chars, zero
+        OP_VAR = 3,   // x, y, LayoutVar
+        OP_GLYPH = 4, // x, y, glyph low byte, glyph high byte
+        OP_FRAME = 5, // x, y, w, h
+        OP_BOX = 6,   // x, y, w, h
+        OP_LINE = 7,  // x0, y0, x1, y1
+        OP_COUNT = 8
+    };
+
+    // instruction sizes, text size is 5 + length
+    static constexpr uint8_t OP_SIZE[WO::LayoutOp::OP_COUNT] = { 1, 2, 5, 4, 5, 5, 5, 5 };
+
+    static constexpr uint8_t LAYOUT_FONT_COUNT = 5;
+    static constexpr const uint8_t* LAYOUT_FONTS[WO::LAYOUT_FONT_COUNT] = {
+        u8g2_font_profont10_tr,
+        u8g2_font_profont10_tn,
+        u8g2_font_profont17_mn,
+        u8g2_font_profont22_tn,
+        WO_FONT_ICONS
+    };
+
+    // values layouts can show
+    enum LayoutVar : uint8_t {
+        VAR_STATE = 0,    // ON/OFF
+        VAR_BRI = 1,
+        VAR_LEDS = 2,
+        VAR_POWER = 3,    // % of ABL limit
+        VAR_FPS = 4,
+        VAR_PRESET = 5,
+        VAR_PLAYLIST = 6,
+        VAR_EFFECT = 7,
+        VAR_PALETTE = 8,
+        VAR_SPEED = 9,
+        VAR_INTENSITY = 10,
+        VAR_SSID = 11,
+        VAR_IP = 12,
+        VAR_SIGNAL = 13,  // %
+        VAR_TIME = 14,    // HH:MM
+        VAR_SECONDS = 15,
+        VAR_DATE = 16,    // dd.mm.yyyy
+        VAR_WEEKDAY = 17,
+        VAR_UPTIME = 18,  // s
+        VAR_COUNT = 19
+    };
+
+    // variables grouped by the data they need
+    static constexpr uint32_t LED_VARS = 0x1F;      // state, bri, leds, power, fps
+    static constexpr uint32_t FX_VARS = 0x7E2;      // bri, preset, playlist, effect, palette, speed, intensity
+    static constexpr uint32_t WIFI_VARS = 0x3800;   // ssid, ip, signal
+    static constexpr uint32_t TIME_VARS = 0x3C000;  // time, seconds, date, weekday
+    static constexpr uint32_t TECH_VARS = 0x40000;  // uptime
+
+    // segment values shown by segments screen
+    struct SegmentInfo {
+        bool active;
+        bool on;
+        uint8_t mode;
+        uint8_t palette;
+        uint8_t opacity;          // segment brightness
+        uint16_t length;
+    };
+
+    // everything drawing routines need, copied from WLED state by `loop`
+    // so the frame can be rendered without touching WLED globals
+    struct Frame {
+        uint32_t id;              // frame sequence number, new id - new image
+        WO::Screen screen;        // screen or screensaver to draw
+        bool panelOn;             // display power
+        uint8_t contrast;         // display contrast
+        uint8_t shiftX;           // pixel shift
+        uint8_t shiftY;
+        uint8_t animationFrame;   // splash and clock screensaver animation
+        uint8_t layout;           // user-defined screen index
+
+        // wifi
+        WO::WifiMode wifiState;
+        char ssid[33];
+        char ip[16];
+        char pass[13];            // only 9 chars fit the screen
+        uint8_t signal;
+
+        // led and fx
+        uint8_t bri;
+        uint16_t ledCount;
+        uint16_t power;           // % of ABL limit
+        uint16_t fps;
+        int16_t preset;
+        int16_t playlist;
+        uint8_t effect;           // effect selected in menu
+        uint8_t mode;             // main segment effect
+        uint8_t palette;
+        uint8_t speed;
+        uint8_t intensity;
+
+        // segments
+        WO::SegmentInfo segment;  // displayed segment
+        uint8_t segmentId;
+        uint8_t segmentIndex;     // position among active segments, 1-based
+        uint8_t segmentCount;     // active segments
+
+        // tech info and about
+        uint16_t fsUsage;         // %
+        uint16_t heapUsage;       // %
+        uint16_t sketchUsage;     // %
+        uint32_t uptime;          // s
+        char coreVersion[16];
+        uint32_t chipId;
+
+        // time and date
+        uint8_t hour;
+        uint8_t minute;
+        uint8_t second;
+        uint8_t day;
+        uint8_t month;
+        uint16_t year;
+        uint8_t weekday;          // 1 - sunday
+
+        // display info
+        uint8_t lowContrast;
+        uint8_t highContrast;
+        WO::Screen screenSaver;
+    };
+
+#ifdef WO_RENDER_TASK
+    // values written by render task and read by `loop` or web handlers
+    template <typename T> using Shared = std::atomic<T>;
+#else
+    template <typename T> using Shared = T;
+#endif
+
+#ifdef WO_RENDER_TASK
+    static constexpr uint32_t RENDER_TASK_STACK = 4096;
+    static constexpr UBaseType_t RENDER_TASK_PRIORITY = 1;
+
+    // lock-free single-producer/single-consumer slot with the latest published frame
+    // three buffers: one written by `loop`, one read by render task and one shared
+    class FrameSlot {
+        static constexpr uint8_t FRESH = 4; // shared buffer wasn't read yet
+        Frame buffers[3];
+        std::atomic<uint8_t> shared;
+        uint8_t writeIdx;
+        uint8_t readIdx;
+
+    public:
+        FrameSlot() : shared(1), writeIdx(0), readIdx(2) {}
+
+        Frame& back() {
+            return buffers[writeIdx];
+        }
+
+        // producer: make back buffer visible to consumer
+        void publish() {
+            writeIdx = shared.exchange(writeIdx | FRESH, std::memory_order_acq_rel) & 3;
+        }
+
+        // consumer: take latest published buffer, returns false if nothing new
+        bool fetch() {
+            if ((shared.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+            readIdx = shared.exchange(readIdx, std::memory_order_acq_rel) & 3;
+            return true;
+        }
+
+        const Frame& front() const {
+            return buffers[readIdx];
+        }
+    };
+#endif
+
     U8G2_SSD1306_64X48_ER_F_HW_I2C display;
     
-    unsigned long lastUpdate;      // timepoint(ms) of latest render
-    unsigned long lastActionPress; // timepoint(ms) of latest action button press
-    unsigned long lastMenuPress;   // timepoint(ms) of latest menu button press
-    unsigned long lastWokeUp;      // timepoint(ms) of last `wakeUp` call
+    uint32_t lastUpdate;      // timepoint(ms) of latest render
+    uint32_t lastActionPress; // timepoint(ms) of latest action button press
+    uint32_t lastMenuPress;   // timepoint(ms) of latest menu button press
+    uint32_t lastWokeUp;      // timepoint(ms) of last `wakeUp` call
     
     bool enabled;            
     uint8_t lowContrast;     // idle contrast
     uint8_t highContrast;    // in-use contrast
+    bool adaptiveContrast;   // lower contrast for frames with many lit pixels
+    bool pixelShift;         // periodically shift image to spread pixel wear
+
+    uint8_t contrast;              // contrast actually set on the display
+    uint8_t targetContrast;        // contrast the display fades to
+    uint8_t contrastFadeStep;      // contrast change per fade step
+    uint16_t contrastLitPixels;    // lit pixels `targetContrast` was picked for
+    uint32_t lastContrastStep;     // timepoint(ms) of latest fade step
+    uint8_t shiftPhase;            // index in SHIFT_X/SHIFT_Y
+
+    bool panelOn;                  // requested display power
+
+    Frame frame;                   // latest frame prepared by `loop`
+
+    // render side state, in task mode it's written by render task only
+    bool displayOn;                           // display power actually set
+    uint8_t displayContrast;                  // display contrast actually set
+    uint32_t drawnFrame;                      // id of the latest rendered frame
+    WO::Screen drawnScreen;                   // screen of the latest rendered frame
+    uint8_t sentBuffer[WO::FRAME_SIZE];       // frame buffer as it was sent to display
+    WO::Shared<uint16_t> litPixels;           // lit pixels of the displayed frame
+    uint16_t pageLitPixels[WO::PANEL_PAGES];  // the same per display page
+    uint64_t pageWear[WO::PANEL_PAGES];       // accumulated per page on-time, pixel*ms
+    WO::Shared<uint32_t> wearHours;           // on-time of the most worn page
+    uint32_t lastWearUpdate;                  // timepoint(ms) of latest wear accounting
+
+#ifdef WO_RENDER_TASK
+    FrameSlot slot;                // frames passed from `loop` to render task
+    TaskHandle_t renderTask;
+#endif
+
+    uint32_t btnTimeout;         // button debounce timeout
+    uint32_t menuExitTimeout;    // quit menu after this period of inactivity
+    uint32_t screensaverTimeout; // enable screensaver mode after this period of inactivity
+    uint32_t highlightTimeout;   // set min contrast after this period of inactivity
+    uint32_t clockRate;          // update rate of time screen and screensavers
+    uint32_t ledRate;            // update rate of led and fx screens
+    uint32_t infoRate;           // update rate of other info screens
+    uint32_t aboutRate;          // update rate of about screen
+
+    uint16_t maxBytesPerSec;          // display I2C traffic budget, 0 - unlimited
+    int32_t budget;                   // available traffic, bytes*1000
+    uint32_t lastBudgetUpdate;        // timepoint(ms) of latest budget refill
     
     bool ready;              // is display HW ready to communicate
     bool redraw;             // force redraw flag
@@ -82,6 +385,29 @@ private:
     bool screenSaving;       // is display in ss mode
     bool highlighting;       // is display highlighted
     bool ssClockMoveForward; // flag for animation in clock screensaver
+    bool actionHeld;         // action button is held since the latest press
+    bool repeating;          // action is auto-repeated
+    bool statePending;       // state was changed but not published yet
+    bool configUpdated;      // settings were saved, apply them in `loop`
+    bool newEnabled;         // `enabled` value from saved settings
+
+    uint32_t lastStateChange; // timepoint(ms) of latest unpublished state change
+
+#ifndef WEMOS_OLED_NO_CUSTOM_SCREENS
+    uint8_t layoutData[WO::LAYOUT_SIZE];      // user-defined screens bytecode
+    uint16_t layoutOffset[WO::MAX_LAYOUTS];   // screen bytecode offsets in `layoutData`
+    uint32_t layoutVars[WO::MAX_LAYOUTS];     // LayoutVar bits used by screen
+    uint8_t layoutCount;                      // number of loaded screens
+    uint8_t customPage;                       // displayed user-defined screen
+#endif
+
+#ifndef WEMOS_OLED_NO_SEGMENTS_SCREEN
+    WO::SegmentInfo segmentCache[WO::MAX_SEGMENTS]; // latest seen values of every segment
+    uint8_t activeSegments;                   // active segments in cache
+    uint8_t segmentPage;                      // displayed segment id
+    uint8_t segmentScan;                      // segment checked by the latest `updateSegments` call
+    uint32_t lastPageFlip;                    // timepoint(ms) of latest segment page change
+#endif
 
     WO::Screen activeScreen;   // screen to render
     WO::Screen renderedScreen; // screen that's actually rendered
@@ -92,66 +418,551 @@ private:
     /* Utility functions */
 
     // update rate in ms for current mode/screen
-    unsigned long getUpdateRate() const {
+    uint32_t getUpdateRate() const {
         if (screenSaving) {
-            return 1000;
+            return clockRate;
         }
-        if (activeScreen == WO::Screen::SPLASH) return 500;
-        if (activeScreen == WO::Screen::TIME_AND_DATE) return 1000;
+        if (activeScreen == WO::Screen::SPLASH) return WO::SPLASH_RATE;
+        if (activeScreen == WO::Screen::TIME_AND_DATE) return clockRate;
         if (activeScreen == WO::Screen::LED ||
-            activeScreen == WO::Screen::FX) return 3000;
-        if (activeScreen == WO::Screen::ABOUT) return 30000;
-        return 10000;
+            activeScreen == WO::Screen::FX) return ledRate;
+        if (activeScreen == WO::Screen::ABOUT) return aboutRate;
+#ifndef WEMOS_OLED_NO_CUSTOM_SCREENS
+        if (activeScreen == WO::Screen::CUSTOM) {
+            uint32_t vars = layoutVars[customPage];
+            if (vars & WO::TIME_VARS) return clockRate;
+            if (vars & (WO::LED_VARS | WO::FX_VARS)) return ledRate;
+        }
+#endif
+        return infoRate;
     }
 
     // returns whether update is neccessary
     bool isRedrawNeeded() const {
-        return redraw || // force redraw
+        return hasBandwidth() && (
+            redraw || // force redraw
             renderedScreen != activeScreen || // not synced
-            (millis() - lastUpdate >= getUpdateRate());
+            (millis() - lastUpdate >= getUpdateRate()));
     }
 
     // the same as previous but for screensaver mode
     bool isScreensaverRedrawNeeded() const {
-        return renderedScreen != screenSaver || // not displayed yet
-            (millis() - lastUpdate >= getUpdateRate());
+        return hasBandwidth() && (
+            renderedScreen != screenSaver || // not displayed yet
+            (millis() - lastUpdate >= getUpdateRate()));
+    }
+
+    /* Bandwidth governor */
+
+    // refill traffic budget, at most one frame can be saved up
+    // so frames are spaced by at least FRAME_BYTES / maxBytesPerSec
+    void refillBudget() {
+        uint32_t now = millis();
+        auto elapsed = min(now - lastBudgetUpdate, WO::MAX_BUDGET_PERIOD);
+        lastBudgetUpdate = now;
+        if (maxBytesPerSec == 0) return;
+        budget = min(int32_t(WO::FRAME_BYTES) * 1000, budget + int32_t(elapsed * maxBytesPerSec));
+    }
+
+    // is there enough budget to send a frame
+    bool hasBandwidth() const {
+        return maxBytesPerSec == 0 || budget >= int32_t(WO::FRAME_BYTES) * 1000;
+    }
+
+    // account sent bytes, budget may go below zero
+    void spendBandwidth(uint16_t bytes) {
+        if (maxBytesPerSec == 0) return;
+        budget -= int32_t(bytes) * 1000;
+    }
+
+    // is screen or screensaver compiled in
+    static constexpr bool isScreenEnabled(WO::Screen screen) {
+        return (void)screen, // unused if everything is compiled in
+#ifdef WEMOS_OLED_NO_LED_SCREEN
+            screen != WO::Screen::LED &&
+#endif
+#ifdef WEMOS_OLED_NO_FX_SCREEN
+            screen != WO::Screen::FX &&
+#endif
+#ifdef WEMOS_OLED_NO_TECH_SCREEN
+            screen != WO::Screen::TECH_INFO &&
+#endif
+#ifdef WEMOS_OLED_NO_TIME_SCREEN
+            screen != WO::Screen::TIME_AND_DATE &&
+#endif
+#ifdef WEMOS_OLED_NO_DISPLAY_SCREEN
+            screen != WO::Screen::DISPLAY_INFO &&
+#endif
+#ifdef WEMOS_OLED_NO_ABOUT_SCREEN
+            screen != WO::Screen::ABOUT &&
+#endif
+#ifdef WEMOS_OLED_NO_CUSTOM_SCREENS
+            screen != WO::Screen::CUSTOM &&
+#endif
+#ifdef WEMOS_OLED_NO_SEGMENTS_SCREEN
+            screen != WO::Screen::SEGMENTS &&
+#endif
+#ifdef WEMOS_OLED_NO_NIGHTSKY
+            screen != WO::Screen::SCREENSAVER_NIGHTSKY &&
+#endif
+#ifdef WEMOS_OLED_NO_CLOCK_SCREENSAVER
+            screen != WO::Screen::SCREENSAVER_CLOCK &&
+#endif
+            true;
+    }
+
+    // is screen compiled in and has something to show
+    bool isScreenAvailable(WO::Screen screen) const {
+#ifndef WEMOS_OLED_NO_CUSTOM_SCREENS
+        if (screen == WO::Screen::CUSTOM && layoutCount == 0) return false;
+#endif
+        return isScreenEnabled(screen);
     }
 
     // timepoint in ms of the last button press/wake up
-    unsigned long mostRecentAction() const {
-        return max({
-            lastActionPress,
-            lastMenuPress,
-            lastWokeUp
-        });
+    // every press wakes display up, timepoints aren't compared with `max`
+    // as it picks a stale one after millis() rollover
+    uint32_t mostRecentAction() const {
+        return lastWokeUp;
     }
 
     /*  Display logic  */
 
     // activate display
     void enable() {
-        display.setPowerSave(0);
-        display.clearDisplay();
+        panelOn = true;
+        publish();
+        spendBandwidth(WO::COMMAND_BYTES + WO::FRAME_BYTES);
     }
 
     // deactivate display
     void disable() {
-        display.setPowerSave(1);
+        panelOn = false;
+        publish();
+        spendBandwidth(WO::COMMAND_BYTES);
     }
 
     // enable display highlighting
     void highlight() {
         if (highlighting) return;
         highlighting = true;
-        display.setContrast(highContrast);
+        updateContrast();
     }
 
     // disable display higlighting
     void setIdle() {
         if (highlighting) {
             highlighting = false;
-            display.setContrast(lowContrast);
+            updateContrast();
+        }
+    }
+
+    // pick contrast for the current highlighting state and frame
+    void updateContrast() {
+        uint8_t newContrast = highlighting ? highContrast : lowContrast;
+        uint16_t lit = litPixels;
+        contrastLitPixels = lit;
+        if (adaptiveContrast && lit > WO::ADAPTIVE_LIT_LIMIT) {
+            // keep estimated panel current at the level of ADAPTIVE_LIT_LIMIT pixels
+            newContrast = (uint32_t(newContrast) * WO::ADAPTIVE_LIT_LIMIT) / lit;
+        }
+        if (newContrast == targetContrast) return;
+        targetContrast = newContrast;
+        uint8_t diff = contrast > targetContrast ? contrast - targetContrast : targetContrast - contrast;
+        contrastFadeStep = max(1, (diff + WO::CONTRAST_FADE_STEPS - 1) / WO::CONTRAST_FADE_STEPS);
+    }
+
+    // move contrast one step closer to the target
+    void fadeContrast() {
+        if (contrast == targetContrast) return;
+        uint32_t now = millis();
+        if (now - lastContrastStep < WO::CONTRAST_FADE_STEP) return;
+        lastContrastStep = now;
+        if (contrast < targetContrast) {
+            contrast = min(int(targetContrast), contrast + contrastFadeStep);
+        } else {
+            contrast = max(int(targetContrast), contrast - contrastFadeStep);
+        }
+        publish();
+        spendBandwidth(WO::COMMAND_BYTES);
+    }
+
+    // add on-time of the displayed frame to per page wear counters
+    void trackWear() {
+        uint32_t now = millis();
+        auto dt = now - lastWearUpdate;
+        lastWearUpdate = now;
+        for (uint8_t p = 0; p < WO::PANEL_PAGES; ++p) {
+            pageWear[p] += uint64_t(pageLitPixels[p]) * dt;
+        }
+    }
+
+    // count lit pixels of the frame buffer page by page
+    void countLitPixels() {
+        trackWear();
+        const uint8_t* buf = display.getBufferPtr();
+        uint16_t total = 0;
+        for (uint8_t p = 0; p < WO::PANEL_PAGES; ++p) {
+            uint16_t count = 0;
+            // every byte is a vertical 8 pixel column, count them 4 at once
+            for (uint8_t i = 0; i < WO::PANEL_WIDTH; i += 4) {
+                uint32_t word;
+                memcpy(&word, buf + i, 4);
+                count += __builtin_popcount(word);
+            }
+            pageLitPixels[p] = count;
+            total += count;
+            buf += WO::PANEL_WIDTH;
         }
+        litPixels = total;
+    }
+
+    // shift frame buffer right by `dx` and down by `dy` pixels (0 or 1)
+    void shiftBuffer(uint8_t dx, uint8_t dy) {
+        uint8_t* buf = display.getBufferPtr();
+        if (dx > 0) {
+            for (uint8_t p = 0; p < WO::PANEL_PAGES; ++p) {
+                uint8_t* page = buf + p * WO::PANEL_WIDTH;
+                memmove(page + 1, page, WO::PANEL_WIDTH - 1);
+                page[0] = 0;
+            }
+        }
+        if (dy > 0) {
+            // bit 0 is the top row of a page, carry the bottom row into the next page
+            for (uint8_t p = WO::PANEL_PAGES - 1; p > 0; --p) {
+                uint8_t* page = buf + p * WO::PANEL_WIDTH;
+                for (uint8_t i = 0; i < WO::PANEL_WIDTH; ++i) {
+                    page[i] = (page[i] << 1) | (page[i - WO::PANEL_WIDTH] >> 7);
+                }
+            }
+            for (uint8_t i = 0; i < WO::PANEL_WIDTH; ++i) {
+                buf[i] <<= 1;
+            }
+        }
+    }
+
+    // estimated panel current in uA
+    uint32_t estimateCurrent() const {
+        return (uint32_t(litPixels) * contrast * WO::PIXEL_CURRENT_NA) / (255 * 1000);
+    }
+
+    // on-time of the most worn page in hours of being fully lit
+    uint32_t maxPageWearHours() const {
+        uint64_t maxWear = 0;
+        for (uint8_t p = 0; p < WO::PANEL_PAGES; ++p) {
+            if (pageWear[p] > maxWear) maxWear = pageWear[p];
+        }
+        return maxWear / (uint64_t(WO::PANEL_WIDTH) * 8 * 3600000);
+    }
+
+#ifndef WEMOS_OLED_NO_CUSTOM_SCREENS
+    /* User-defined screens */
+
+    // check screen bytecode starting at `pc` and collect variables it uses
+    bool validateLayout(uint16_t pc, uint16_t size, uint32_t& vars) const {
+        while (pc < size) {
+            uint8_t op = layoutData[pc];
+            if (op == WO::LayoutOp::OP_END) return true;
+            if (op >= WO::LayoutOp::OP_COUNT) return false;
+            uint16_t len = WO::OP_SIZE[op];
+            if (op == WO::LayoutOp::OP_TEXT && pc + 3 < size) {
+                len += layoutData[pc + 3];
+            }
+            if (pc + len > size) return false;
+            if (op == WO::LayoutOp::OP_TEXT && layoutData[pc + len - 1] != 0) return false;
+            if (op == WO::LayoutOp::OP_FONT && layoutData[pc + 1] >= WO::LAYOUT_FONT_COUNT) return false;
+            if (op == WO::LayoutOp::OP_VAR) {
+                if (layoutData[pc + 3] >= WO::LayoutVar::VAR_COUNT) return false;
+                vars |= 1UL << layoutData[pc + 3];
+            }
+            pc += len;
+        }
+        return false; // no OP_END
+    }
+
+    // load screens compiled by tools/oled_layout.py
+    // file: 'W', 'O', version, screen count, 16-bit LE offsets of screens, bytecode
+    void loadLayouts() {
+        layoutCount = 0;
+        if (!WLED_FS.exists(WO::LAYOUT_FILE)) return;
+        File file = WLED_FS.open(WO::LAYOUT_FILE, "r");
+        if (!file) return;
+        size_t size = file.size();
+        if (size > WO::LAYOUT_SIZE) {
+            file.close();
+            return;
+        }
+        size = file.read(layoutData, size);
+        file.close();
+
+        if (size < 4 ||
+            layoutData[0] != 'W' ||
+            layoutData[1] != 'O' ||
+            layoutData[2] != WO::LAYOUT_VERSION) return;
+        uint8_t count = layoutData[3];
+        if (count == 0 || count > WO::MAX_LAYOUTS || size < 4u + 2 * count) return;
+        for (uint8_t i = 0; i < count; ++i) {
+            layoutOffset[i] = layoutData[4 + 2 * i] | (layoutData[5 + 2 * i] << 8);
+            layoutVars[i] = 0;
+            if (!validateLayout(layoutOffset[i], size, layoutVars[i])) return;
+        }
+        layoutCount = count;
+    }
+#endif
+
+#ifndef WEMOS_OLED_NO_SEGMENTS_SCREEN
+    /* Segments screen */
+
+    // refresh cached values of segment `id`, returns whether they changed
+    bool updateSegmentCache(uint8_t id) {
+        WO::SegmentInfo info = {};
+        if (id < strip.getSegmentsNum()) {
+            Segment& seg = strip.getSegment(id);
+            info.active = seg.isActive();
+            if (info.active) {
+                info.on = seg.on;
+                info.mode = seg.mode;
+                info.palette = seg.palette;
+                info.opacity = seg.opacity;
+                info.length = seg.length();
+            }
+        }
+        WO::SegmentInfo& cached = segmentCache[id];
+        if (info.active == cached.active &&
+            info.on == cached.on &&
+            info.mode == cached.mode &&
+            info.palette == cached.palette &&
+            info.opacity == cached.opacity &&
+            info.length == cached.length) return false;
+        if (info.active != cached.active) {
+            activeSegments += info.active ? 1 : -1;
+        }
+        cached = info;
+        return true;
+    }
+
+    // refresh the whole cache, used when segments screen is opened
+    void updateAllSegments() {
+        for (uint8_t id = 0; id < WO::MAX_SEGMENTS; ++id) {
+            updateSegmentCache(id);
+        }
+        if (!segmentCache[segmentPage].active) flipSegmentPage();
+        lastPageFlip = millis();
+    }
+
+    // show the next active segment
+    void flipSegmentPage() {
+        lastPageFlip = millis();
+        for (uint8_t i = 1; i <= WO::MAX_SEGMENTS; ++i) {
+            uint8_t id = (segmentPage + i) % WO::MAX_SEGMENTS;
+            if (!segmentCache[id].active) continue;
+            updateSegmentCache(id); // cached values may be stale
+            if (!segmentCache[id].active) continue;
+            if (id != segmentPage) {
+                segmentPage = id;
+                redraw = true;
+            }
+            return;
+        }
+    }
+
+    // check the displayed segment and one more per call, so every loop stays cheap
+    // only changes of the displayed page or of the active segment count cause redraw
+    void updateSegments() {
+        if (updateSegmentCache(segmentPage)) redraw = true;
+        segmentScan = (segmentScan + 1) % WO::MAX_SEGMENTS;
+        if (segmentScan != segmentPage) {
+            uint8_t count = activeSegments;
+            updateSegmentCache(segmentScan);
+            if (activeSegments != count) redraw = true;
+        }
+        if (!segmentCache[segmentPage].active ||
+            millis() - lastPageFlip >= WO::SEGMENT_PAGE_RATE) {
+            flipSegmentPage();
+        }
+    }
+#endif
+
+    /* Frame passing */
+
+    // values that never change are copied into `frame` once by `setup`
+    void fillConstantInfo() {
+        Frame& f = frame;
+#ifdef ARDUINO_ARCH_ESP32
+        strlcpy(f.coreVersion, ESP.getSdkVersion(), sizeof(f.coreVersion));
+        // the same 3 MAC bytes as ESP8266 chip id
+        uint64_t mac = ESP.getEfuseMac();
+        f.chipId = 0;
+        for (uint8_t i = 0; i < 24; i += 8) {
+            f.chipId |= ((mac >> (40 - i)) & 0xFF) << i;
+        }
+#else
+        strlcpy(f.coreVersion, ESP.getCoreVersion().c_str(), sizeof(f.coreVersion));
+        f.chipId = ESP.getChipId();
+#endif
+    }
+
+    // copy WLED state needed to draw current screen into `frame`
+    void fillFrame() {
+        Frame& f = frame;
+        f.screen = screenSaving ? screenSaver : activeScreen;
+        f.animationFrame = animationFrame;
+        bool shift = pixelShift && !screenSaving;
+        f.shiftX = shift ? WO::SHIFT_X[shiftPhase] : 0;
+        f.shiftY = shift ? WO::SHIFT_Y[shiftPhase] : 0;
+#ifndef WEMOS_OLED_NO_CUSTOM_SCREENS
+        f.layout = customPage;
+        // variables used by user-defined screen
+        uint32_t vars = f.screen == WO::Screen::CUSTOM ? layoutVars[customPage] : 0;
+#else
+        uint32_t vars = 0;
+#endif
+
+        if (f.screen == WO::Screen::WIFI || (vars & WO::WIFI_VARS)) {
+            f.wifiState = wifiState;
+            if (wifiState == WO::WifiMode::AP) {
+                strlcpy(f.ssid, apSSID, sizeof(f.ssid));
+                strlcpy(f.pass, apPass, sizeof(f.pass));
+                strlcpy(f.ip, "4.3.2.1", sizeof(f.ip));
+                f.signal = 0;
+            }
+            if (wifiState == WO::WifiMode::CLIENT) {
+                strlcpy(f.ssid, WiFi.SSID().c_str(), sizeof(f.ssid));
+                strlcpy(f.ip, Network.localIP().toString().c_str(), sizeof(f.ip));
+                f.signal = getSignalQuality(WiFi.RSSI());
+            }
+            if (wifiState == WO::WifiMode::NONE) {
+                f.ssid[0] = 0;
+                f.ip[0] = 0;
+                f.signal = 0;
+            }
+        }
+        if (f.screen == WO::Screen::LED || (vars & WO::LED_VARS)) {
+            f.bri = bri;
+            f.ledCount = strip.getLengthTotal();
+            f.power = (100 * strip.currentMilliamps) / strip.ablMilliampsMax;
+            f.fps = strip.getFps();
+        }
+        if (f.screen == WO::Screen::FX || (vars & WO::FX_VARS)) {
+            f.bri = bri;
+            f.preset = currentPreset;
+            f.playlist = currentPlaylist;
+            f.mode = strip.getMainSegment().mode;
+            f.palette = strip.getMainSegment().palette;
+            f.speed = effectSpeed;
+            f.intensity = effectIntensity;
+        }
+        if (f.screen == WO::Screen::TECH_INFO || (vars & WO::TECH_VARS)) {
+            f.fsUsage = (100 * fsBytesUsed) / fsBytesTotal;
+#ifdef ARDUINO_ARCH_ESP32
+            uint32_t heapSize = ESP.getHeapSize();
+#else
+            uint32_t heapSize = 81920; // ESP8266 RAM
+#endif
+            f.heapUsage = (100 * (heapSize - ESP.getFreeHeap())) / heapSize;
+            f.sketchUsage = (100 * ESP.getSketchSize()) / ESP.getFreeSketchSpace();
+            f.uptime = ((uint64_t(rolloverMillis) << 32) | millis()) / 1000;
+        }
+#ifndef WEMOS_OLED_NO_SEGMENTS_SCREEN
+        if (f.screen == WO::Screen::SEGMENTS) {
+            f.segment = segmentCache[segmentPage];
+            f.segmentId = segmentPage;
+            f.segmentCount = activeSegments;
+            f.segmentIndex = 0;
+            for (uint8_t id = 0; id <= segmentPage; ++id) {
+                if (segmentCache[id].active) ++f.segmentIndex;
+            }
+        }
+#endif
+        if (f.screen == WO::Screen::TIME_AND_DATE || f.screen == WO::Screen::SCREENSAVER_CLOCK ||
+            (vars & WO::TIME_VARS)) {
+            updateLocalTime();
+            f.hour = hour(localTime);
+            f.minute = minute(localTime);
+            f.second = second(localTime);
+            f.day = day(localTime);
+            f.month = month(localTime);
+            f.year = year(localTime);
+            f.weekday = weekday(localTime);
+        }
+        if (f.screen == WO::Screen::DISPLAY_INFO) {
+            f.lowContrast = lowContrast;
+            f.highContrast = highContrast;
+            f.screenSaver = screenSaver;
+        }
+        if (f.screen == WO::Screen::MENU_NEXT_EFFECT ||
+            f.screen == WO::Screen::MENU_BRI_PLUS ||
+            f.screen == WO::Screen::MENU_BRI_MINUS) {
+            f.bri = bri;
+            f.effect = effectCurrent;
+        }
+    }
+
+    // pass display power, contrast and latest frame to the render side
+    void publish() {
+        frame.panelOn = panelOn;
+        frame.contrast = contrast;
+#ifdef WO_RENDER_TASK
+        if (renderTask != nullptr) {
+            memcpy(&slot.back(), &frame, sizeof(Frame));
+            slot.publish();
+            xTaskNotifyGive(renderTask);
+            return;
+        }
+#endif
+        present(frame);
+    }
+
+#ifdef WO_RENDER_TASK
+    static void renderLoop(void* arg) {
+        WO* self = static_cast<WO*>(arg);
+        for (;;) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            if (self->slot.fetch()) {
+                self->present(self->slot.front());
+            }
+        }
+    }
+#endif
+
+    /* Render side */
+
+    // apply display state from frame and render it if it's new
+    void present(const Frame& f) {
+        if (f.panelOn != displayOn) {
+            displayOn = f.panelOn;
+            if (displayOn) {
+                display.setPowerSave(0);
+                display.clearDisplay();
+                memset(sentBuffer, 0, sizeof(sentBuffer));
+                countLitPixels();
+            } else {
+                display.setPowerSave(1);
+                trackWear();
+                litPixels = 0;
+                memset(pageLitPixels, 0, sizeof(pageLitPixels));
+            }
+        }
+        if (f.contrast != displayContrast) {
+            displayContrast = f.contrast;
+            display.setContrast(displayContrast);
+        }
+        if (f.id == drawnFrame) return;
+        drawnFrame = f.id;
+        drawFrame(f);
+        drawnScreen = f.screen;
+        if (f.shiftX > 0 || f.shiftY > 0) {
+            shiftBuffer(f.shiftX, f.shiftY);
+        }
+        // static image keeps wearing the panel even if it isn't flushed again
+        trackWear();
+        wearHours = maxPageWearHours();
+        // keep the sent frame to skip flushing identical images
+        const uint8_t* buf = display.getBufferPtr();
+        if (memcmp(buf, sentBuffer, WO::FRAME_SIZE) == 0) return;
+        display.sendBuffer();
+        memcpy(sentBuffer, buf, WO::FRAME_SIZE);
+        countLitPixels();
     }
 
     // exit screensaver mode if needed and enable highlighting
@@ -169,18 +980,53 @@ private:
         return false;
     }
 
+    // apply settings saved by `readFromConfig`
+    void applyConfig() {
+        configUpdated = false;
+        wakeUp();
+        updateContrast();
+        if (enabled != newEnabled) {
+            if (newEnabled) {
+                enable();
+                redraw = true;
+            } else {
+                disable();
+            }
+        }
+        enabled = newEnabled;
+    }
+
     // select screen/action in a round robin manner
     void nextScreen() {
         redraw = true;
-        if (activeScreen == WO::Screen::ABOUT) {
-            activeScreen = WO::Screen::WIFI;
-            return;
-        }
         if (activeScreen == WO::Screen::MENU_EXIT) {
             activeScreen = WO::Screen::MENU_POWER; 
             return;
         }
-        activeScreen = WO::Screen(activeScreen + 1);
+        if (activeScreen >= WO::Screen::MENU_POWER) {
+            activeScreen = WO::Screen(activeScreen + 1);
+            return;
+        }
+#ifndef WEMOS_OLED_NO_CUSTOM_SCREENS
+        if (activeScreen == WO::Screen::CUSTOM && customPage + 1 < layoutCount) {
+            ++customPage;
+            return;
+        }
+        customPage = 0;
+#endif
+        // skip screens dropped at compile time, wifi screen is always available
+        do {
+            if (activeScreen == WO::Screen::SEGMENTS) {
+                activeScreen = WO::Screen::WIFI;
+            } else {
+                activeScreen = WO::Screen(activeScreen + 1);
+            }
+        } while (!isScreenAvailable(activeScreen));
+#ifndef WEMOS_OLED_NO_SEGMENTS_SCREEN
+        if (activeScreen == WO::Screen::SEGMENTS) {
+            updateAllSegments();
+        }
+#endif
     }
 
     // open `actions` menu
@@ -199,6 +1045,33 @@ private:
         activeScreen = WO::Screen::WIFI;
         menu = false;
         redraw = true;
+        publishState();
+    }
+
+    // can action be auto-repeated while button is held
+    bool isRepeatable() const {
+        return menu && (
+            activeScreen == WO::Screen::MENU_BRI_PLUS ||
+            activeScreen == WO::Screen::MENU_BRI_MINUS ||
+            activeScreen == WO::Screen::MENU_NEXT_EFFECT);
+    }
+
+    // apply state change locally, notifications are sent by `publishState`
+    // `colorUpdated` copies globals to segments first, `stateUpdated` alone
+    // would reload them from the segment and drop the change
+    void updateStateQuietly() {
+        colorUpdated(CALL_MODE_NO_NOTIFY);
+        statePending = true;
+        lastStateChange = millis();
+        redraw = true;
+    }
+
+    // send coalesced state changes (sync, notifications, etc.)
+    void publishState() {
+        if (!statePending) return;
+        statePending = false;
+        stateChanged = true; // local state is already applied, force notifications
+        stateUpdated(CALL_MODE_BUTTON);
     }
 
     // execute current selected action
@@ -227,6 +1100,7 @@ private:
         if (activeScreen == WO::Screen::MENU_AP) {
             WLED::instance().initAP(true);
         }
+        // stepping actions stay in menu
         if (activeScreen == WO::Screen::MENU_NEXT_EFFECT) {
             if (effectCurrent == strip.getModeCount() - 1) {
                 effectCurrent = 0;
@@ -234,25 +1108,28 @@ private:
                 ++effectCurrent;
             }
             stateChanged = true;
-            colorUpdated(CALL_MODE_BUTTON);
+            updateStateQuietly();
+            return;
         }
         if (activeScreen == WO::Screen::MENU_BRI_MINUS) {
             if (bri >= 8) {
                 bri -= 8;
-                stateUpdated(CALL_MODE_BUTTON);
+                updateStateQuietly();
             } else if (bri > 1) {
                 bri = 1;
-                stateUpdated(CALL_MODE_BUTTON);
+                updateStateQuietly();
             }
+            return;
         }
         if (activeScreen == WO::Screen::MENU_BRI_PLUS) {
             if (bri <= 247) { 
                 bri += 8;
-                stateUpdated(CALL_MODE_BUTTON);
+                updateStateQuietly();
             } else if (bri < 255) {
                 bri = 255;
-                stateUpdated(CALL_MODE_BUTTON);
+                updateStateQuietly();
             }
+            return;
         }
         if (activeScreen == WO::Screen::MENU_COLOR) {
             setRandomColor(col);
@@ -267,180 +1144,238 @@ private:
         exitMenu();
     }
 
-    /* Drawing functions */
-    
-    // initialize drawing
-    // should called before any drawing routine
-    void startDrawing(bool showIcons = true) {
-        display.clearBuffer();
-        if (showIcons) drawIcons(8);
-    }
-
-    // end drawing and send image to display
+    // prepare new frame of current screen and send it to display
     void show() {
         if (screenSaving) {
             renderedScreen = screenSaver;
         } else {
             renderedScreen = activeScreen;
         }
-        display.sendBuffer();
+        fillFrame();
+        ++frame.id;
+        publish();
+        spendBandwidth(WO::FRAME_BYTES);
         redraw = false;
         lastUpdate = millis();
     }
 
+    /* Drawing functions */
+
+    // draw frame into display buffer
+    void drawFrame(const Frame& f) {
+#ifndef WEMOS_OLED_NO_NIGHTSKY
+        if (f.screen == WO::Screen::SCREENSAVER_NIGHTSKY) {
+            if (drawnScreen != WO::Screen::SCREENSAVER_NIGHTSKY) {
+                // first drawing
+                display.clearBuffer();
+            }
+            drawStar();
+            return;
+        }
+#endif
+        display.clearBuffer();
+#ifndef WEMOS_OLED_NO_CLOCK_SCREENSAVER
+        if (f.screen == WO::Screen::SCREENSAVER_CLOCK) {
+            drawClock(f);
+            return;
+        }
+#endif
+        if (f.screen == WO::Screen::SPLASH) {
+            drawSplash(f);
+            return;
+        }
+        if (f.screen >= WO::Screen::MENU_POWER && f.screen <= WO::Screen::MENU_EXIT) {
+            drawMenuItem(f);
+            return;
+        }
+#ifndef WEMOS_OLED_NO_CUSTOM_SCREENS
+        if (f.screen == WO::Screen::CUSTOM) {
+            drawLayout(f);
+            return;
+        }
+#endif
+#ifndef WEMOS_OLED_NO_SEGMENTS_SCREEN
+        if (f.screen == WO::Screen::SEGMENTS) {
+            drawSegments(f);
+            return;
+        }
+#endif
+        drawIcons(f, 8);
+        // screens are compiled out with their fonts by WEMOS_OLED_NO_* flags
+        if (f.screen == WO::Screen::WIFI) drawWifiData(f);
+#ifndef WEMOS_OLED_NO_LED_SCREEN
+        if (f.screen == WO::Screen::LED) drawLedInfo(f);
+#endif
+#ifndef WEMOS_OLED_NO_FX_SCREEN
+        if (f.screen == WO::Screen::FX) drawFxInfo(f);
+#endif
+#ifndef WEMOS_OLED_NO_TECH_SCREEN
+        if (f.screen == WO::Screen::TECH_INFO) drawTechInfo(f);
+#endif
+#ifndef WEMOS_OLED_NO_TIME_SCREEN
+        if (f.screen == WO::Screen::TIME_AND_DATE) drawTimeAndDate(f);
+#endif
+#ifndef WEMOS_OLED_NO_DISPLAY_SCREEN
+        if (f.screen == WO::Screen::DISPLAY_INFO) drawDisplayInfo(f);
+#endif
+#ifndef WEMOS_OLED_NO_ABOUT_SCREEN
+        if (f.screen == WO::Screen::ABOUT) drawAbout(f);
+#endif
+    }
+
     // draw text in specified line starting from `x`
     void drawLine(u8g2_uint_t lineIdx, const char* text, u8g2_uint_t x = 0) {
         display.drawStr(x, 7 + 10 * lineIdx, text);
     }
 
     // draw top bar
-    void drawIcons(int y) {
-        display.setFont(u8g2_font_open_iconic_all_1x_t);
-        display.drawGlyph(1, y, 248); // wifi
-        display.drawGlyph(10, y, 259); // sun
-        display.drawGlyph(19, y, 211); // play
-        display.drawGlyph(28, y, 129); // tech
-        display.drawGlyph(37, y, 123); // clock
-        display.drawGlyph(46, y, 222); // display
-        display.drawGlyph(55, y, 188); // info
-        display.drawFrame(9 * activeScreen, y - 8, 10, 10);
-    }
-
-    void drawDisplayInfo() {
+    void drawIcons(const Frame& f, int y) {
+        display.setFont(WO_FONT_ICONS);
+        u8g2_uint_t x = 0;
+        for (uint8_t s = WO::Screen::WIFI; s <= WO::Screen::ABOUT; ++s) {
+            if (!isScreenEnabled(WO::Screen(s))) continue;
+            display.drawGlyph(x + 1, y, WO::SCREEN_ICON[s]);
+            if (s == f.screen) {
+                display.drawFrame(x, y - 8, 10, 10);
+            }
+            x += 9;
+        }
+    }
+
+    void drawDisplayInfo(const Frame& f) {
         display.setFont(u8g2_font_profont10_tr);
         
         drawLine(1, "MIN CTR:");
         display.setCursor(40, 17);
-        display.print(lowContrast);
+        display.print(f.lowContrast);
         
         drawLine(2, "MAX CTR:");
         display.setCursor(40, 27);
-        display.print(highContrast);
+        display.print(f.highContrast);
         
         drawLine(3, "SCREENSAVER:");
-        if (screenSaver == WO::Screen::SCREENSAVER_NIGHTSKY) {
+        if (f.screenSaver == WO::Screen::SCREENSAVER_NIGHTSKY) {
             drawLine(4, "NIGHT SKY");
             return;
         }
-        if (screenSaver == WO::Screen::SCREENSAVER_EMPTY) {
+        if (f.screenSaver == WO::Screen::SCREENSAVER_EMPTY) {
             drawLine(4, "EMPTY SCREEN");
             return;
         }
         drawLine(4, "CLOCK");
     }
 
-    void drawMenuItem() {
+    void drawMenuItem(const Frame& f) {
         display.setFont(u8g2_font_profont10_tr);
         
-        if (activeScreen == WO::Screen::MENU_POWER) {
+        if (f.screen == WO::Screen::MENU_POWER) {
             drawLine(4, "POWER ON/OFF", 2);
-            display.setFont(u8g2_font_open_iconic_embedded_4x_t);
+            display.setFont(WO_FONT_EMBEDDED);
             display.drawGlyph(18, 35, 78);
         }
         
-        if (activeScreen == WO::Screen::MENU_REBOOT) {
+        if (f.screen == WO::Screen::MENU_REBOOT) {
             drawLine(4, "REBOOT", 17);
-            display.setFont(u8g2_font_open_iconic_embedded_4x_t);
+            display.setFont(WO_FONT_EMBEDDED);
             display.drawGlyph(16, 35, 79);
         }
 
-        if (activeScreen == WO::Screen::MENU_FACTORY_RESET) {
+        if (f.screen == WO::Screen::MENU_FACTORY_RESET) {
             drawLine(4, "FACTORY RST", 5);
-            display.setFont(u8g2_font_open_iconic_embedded_4x_t);
+            display.setFont(WO_FONT_EMBEDDED);
             display.drawGlyph(18, 35, 71);
         }
 
-        if (activeScreen == WO::Screen::MENU_AP) {
+        if (f.screen == WO::Screen::MENU_AP) {
             drawLine(4, "START AP", 12);
-            display.setFont(u8g2_font_open_iconic_www_4x_t);
+            display.setFont(WO_FONT_WWW);
             display.drawGlyph(18, 35, 81);
         }
 
-        if (activeScreen == WO::Screen::MENU_COLOR) {
+        if (f.screen == WO::Screen::MENU_COLOR) {
             drawLine(4, "RANDOM COLOR", 2);
-            display.setFont(u8g2_font_open_iconic_thing_4x_t);
+            display.setFont(WO_FONT_THING);
             display.drawGlyph(16, 35, 71);
         }
 
-        if (activeScreen == WO::Screen::MENU_NEXT_EFFECT) {
-            drawLine(4, "NEXT EFFECT", 5);
-            display.setFont(u8g2_font_open_iconic_play_4x_t);
+        // stepping actions show current value
+        if (f.screen == WO::Screen::MENU_NEXT_EFFECT) {
+            display.setCursor(2, 47);
+            display.printf("NEXT FX:%d", f.effect);
+            display.setFont(WO_FONT_PLAY);
             display.drawGlyph(16, 35, 72);   
         }
 
-        if (activeScreen == WO::Screen::MENU_BRI_PLUS) {
-            drawLine(4, "+ BRIGHTNESS", 2);
-            display.setFont(u8g2_font_open_iconic_text_4x_t);
+        if (f.screen == WO::Screen::MENU_BRI_PLUS) {
+            display.setCursor(7, 47);
+            display.printf("+ BRI:%d", f.bri);
+            display.setFont(WO_FONT_TEXT);
             display.drawGlyph(16, 35, 88); 
         }
 
-        if (activeScreen == WO::Screen::MENU_BRI_MINUS) {
-            drawLine(4, "- BRIGHTNESS", 2);
-            display.setFont(u8g2_font_open_iconic_text_4x_t);
+        if (f.screen == WO::Screen::MENU_BRI_MINUS) {
+            display.setCursor(7, 47);
+            display.printf("- BRI:%d", f.bri);
+            display.setFont(WO_FONT_TEXT);
             display.drawGlyph(16, 35, 87); 
         }
 
-        if (activeScreen == WO::Screen::MENU_SCREENSAVER) {
+        if (f.screen == WO::Screen::MENU_SCREENSAVER) {
             drawLine(4, "SCREENSAVER", 5);
-            display.setFont(u8g2_font_open_iconic_mime_4x_t);
+            display.setFont(WO_FONT_MIME);
             display.drawGlyph(16, 35, 68);    
         }
 
-        if (activeScreen == WO::Screen::MENU_EXIT) {
+        if (f.screen == WO::Screen::MENU_EXIT) {
             drawLine(4, "EXIT MENU", 10);
-            display.setFont(u8g2_font_open_iconic_gui_4x_t);
+            display.setFont(WO_FONT_GUI);
             display.drawGlyph(16, 35, 65);
         }
     }
 
     // draw animation splash screen
-    void drawSplash() {
-        display.setFont(u8g2_font_open_iconic_www_4x_t);
+    void drawSplash(const Frame& f) {
+        display.setFont(WO_FONT_WWW);
         display.drawGlyph(16, 35, 72);
         display.setFont(u8g2_font_profont10_tr);
         drawLine(4, "LOADING", 8);
-        if (animationFrame > 0) {
+        if (f.animationFrame > 0) {
             display.drawGlyph(43, 47, '.');
         }
-        if (animationFrame > 1) {
+        if (f.animationFrame > 1) {
             display.drawGlyph(48, 47, '.');
         }
-        if (animationFrame > 2) {
+        if (f.animationFrame > 2) {
             display.drawGlyph(53, 47, '.');
         }
-        if (animationFrame == 3) {
-            animationFrame = 0;
-        } else {
-            ++animationFrame;
-        }
     }
 
     // draw wifi data
     // mode, ssid, ip and signal (password in AP mode)
-    void drawWifiData() {
+    void drawWifiData(const Frame& f) {
         display.setFont(u8g2_font_profont10_tr);
         drawLine(1, "MODE:");
-        if (wifiState == WO::WifiMode::AP) { // AP
+        if (f.wifiState == WO::WifiMode::AP) { // AP
             drawLine(1, "AP", 25);
-            drawLine(2, apSSID);
+            drawLine(2, f.ssid);
             drawLine(4, "PWD:");
-            drawLine(4, apPass, 20);
+            drawLine(4, f.pass, 20);
             
             // numeric
             display.setFont(u8g2_font_profont10_tn);
             drawLine(3, "4.3.2.1");
             return;
         }
-        if (wifiState == WO::WifiMode::CLIENT) { // Client
+        if (f.wifiState == WO::WifiMode::CLIENT) { // Client
             drawLine(1, "CLIENT", 25);
-            drawLine(2, WiFi.SSID().c_str());
+            drawLine(2, f.ssid);
             drawLine(4, "SIGNAL:");
             display.setCursor(35, 47);
-            display.printf("%d%%", getSignalQuality(WiFi.RSSI()));
+            display.printf("%d%%", f.signal);
             
             // numeric
             display.setFont(u8g2_font_profont10_tn);
-            drawLine(3, Network.localIP().toString().c_str());
+            drawLine(3, f.ip);
             return;
         } else { // Neither AP, nor Client
             drawLine(1, "NONE", 25);
@@ -452,7 +1387,7 @@ private:
     }
 
     // draw wled, core versions and chip code
-    void drawAbout() {
+    void drawAbout(const Frame& f) {
         display.setFont(u8g2_font_profont10_tr);
         
         drawLine(1, "WLED v"); // wled version
@@ -465,65 +1400,62 @@ private:
         drawLine(1, versionString, 30);
         display.setCursor(30, 27);
         display.print(VERSION);
-        drawLine(3, ESP.getCoreVersion().c_str(), 25);
+        drawLine(3, f.coreVersion, 25);
         display.setCursor(25, 47);
-        display.print(ESP.getChipId());
+        display.print(f.chipId);
     }
 
     // draw memory usage (fs, heap and sketch) and uptime
-    void drawTechInfo() {
+    void drawTechInfo(const Frame& f) {
         display.setFont(u8g2_font_profont10_tr);
         
         // filesystem
         drawLine(1, "FS:");
         display.setCursor(15, 17);
-        display.printf("%d%%", (100 * fsBytesUsed) / fsBytesTotal);
+        display.printf("%d%%", f.fsUsage);
         
         // heap
         drawLine(2, "RAM:");
-        auto heapUsage = (100 * (81920 - ESP.getFreeHeap())) / 81920;
         display.setCursor(20, 27);
-        display.printf("%d%%", heapUsage);
+        display.printf("%d%%", f.heapUsage);
 
         // sketch
         drawLine(3, "PROG:");
-        auto sketchUsage = (100 * ESP.getSketchSize()) / ESP.getFreeSketchSpace();
         display.setCursor(25, 37);
-        display.printf("%d%%", sketchUsage);
+        display.printf("%d%%", f.sketchUsage);
 
         // uptime
         drawLine(4, "UT:");
         display.setFont(u8g2_font_profont10_tn); // set numeric font to save horizontal space
         display.setCursor(15, 47);
-        auto utMinutes = millis() / 1000 + rolloverMillis * 4294967;
-        display.print(utMinutes);
+        display.print(f.uptime);
     }
 
     // draw technical data about the led string
-    void drawLedInfo() {
+    void drawLedInfo(const Frame& f) {
         display.setFont(u8g2_font_profont10_tr);
         // on off
         drawLine(1, "STATE:");
-        drawLine(1, (bri > 0 ? "ON" : "OFF"), 30);
+        drawLine(1, (f.bri > 0 ? "ON" : "OFF"), 30);
 
         // total led count
         drawLine(2, "TOTAL:");
         display.setCursor(30, 27);
-        display.print(strip.getLengthTotal());        
+        display.print(f.ledCount);        
         
         // power consumption
         drawLine(3, "POWER:");
         display.setCursor(30, 37);
-        display.printf("%d %%", (100 * strip.currentMilliamps) / strip.ablMilliampsMax);
+        display.printf("%d %%", f.power);
         
         // fps
         drawLine(4, "FPS:");
         display.setCursor(20, 47);
-        display.print(strip.getFps());
+        display.print(f.fps);
     }
 
     // draw current effect data
-    void drawFxInfo() {
+    void drawFxInfo(const Frame& f) {
         display.setFont(u8g2_font_profont10_tr);
         //preset
         drawLine(1, "preset:");
@@ -543,47 +1475,155 @@ private:
         // print numeric values
         display.setFont(u8g2_font_profont10_tr);
         display.setCursor(35, 17);
-        display.print(currentPreset);
+        display.print(f.preset);
         display.setCursor(15, 27);
-        display.print(bri);
+        display.print(f.bri);
         display.setCursor(48, 27);
-        display.print(strip.getMainSegment().mode);
+        display.print(f.mode);
         display.setCursor(15, 37);
-        display.print(effectSpeed);
+        display.print(f.speed);
         display.setCursor(48, 37);
-        display.print(effectIntensity);
+        display.print(f.intensity);
         display.setCursor(15, 47);
-        display.print(strip.getMainSegment().palette);
+        display.print(f.palette);
         display.setCursor(48, 47);
-        display.print(currentPlaylist);
+        display.print(f.playlist);
+    }
+
+    // draw one active segment per page: state, effect, palette, brightness and length
+    void drawSegments(const Frame& f) {
+        display.setFont(u8g2_font_profont10_tr);
+        if (!f.segment.active) {
+            drawLine(0, "SEGMENTS");
+            drawLine(2, "NO ACTIVE");
+            drawLine(3, "SEGMENTS");
+            return;
+        }
+        // header
+        display.setCursor(0, 7);
+        display.printf("SEG %d/%d", f.segmentIndex, f.segmentCount);
+        drawLine(0, (f.segment.on ? "ON" : "OFF"), 49);
+
+        drawLine(1, "LEN:");
+        display.setCursor(20, 17);
+        display.print(f.segment.length);
+
+        drawLine(2, "FX:");
+        display.setCursor(15, 27);
+        display.print(f.segment.mode);
+
+        drawLine(3, "PAL:");
+        display.setCursor(20, 37);
+        display.print(f.segment.palette);
+
+        drawLine(4, "BRI:");
+        display.setCursor(20, 47);
+        display.print(f.segment.opacity);
+        drawLine(4, "ID:", 38);
+        display.setCursor(53, 47);
+        display.print(f.segmentId);
     }
 
     // draw local time in HH:MM ss format
     // local date in dd.mm.yyyy format
     // and day of week
-    void drawTimeAndDate() {
-        updateLocalTime();
+    void drawTimeAndDate(const Frame& f) {
         display.setFont(u8g2_font_profont17_mn);
         
         //draw clock in two lines
         display.setCursor(0, 27);
-        display.printf("%02d:%02d", hour(localTime), minute(localTime)); //HH:MM
+        display.printf("%02d:%02d", f.hour, f.minute); //HH:MM
 
         // draw seconds 2x smaller
         display.setFont(u8g2_font_profont10_tr);
         display.setCursor(47, 27);
-        display.printf("%02d", second(localTime));
+        display.printf("%02d", f.second);
 
         // date in third line
         display.setCursor(0, 37);
-        display.printf("%02d.%02d.%d", day(localTime), month(localTime), year(localTime));
+        display.printf("%02d.%02d.%d", f.day, f.month, f.year);
 
         //day of week in fourth line
-        drawLine(4, WO::DAY_NAME[weekday(localTime) - 1]);
+        drawLine(4, WO::DAY_NAME[f.weekday - 1]);
+    }
+
+#ifndef WEMOS_OLED_NO_CUSTOM_SCREENS
+    // text of layout variable, `buf` is used for numbers
+    const char* formatVar(const Frame& f, uint8_t var, char* buf, size_t size) const {
+        if (var == WO::LayoutVar::VAR_STATE) return f.bri > 0 ? "ON" : "OFF";
+        if (var == WO::LayoutVar::VAR_SSID) return f.ssid;
+        if (var == WO::LayoutVar::VAR_IP) return f.ip;
+        if (var == WO::LayoutVar::VAR_WEEKDAY) return WO::DAY_NAME[(f.weekday + 6) % 7];
+        if (var == WO::LayoutVar::VAR_TIME) {
+            snprintf(buf, size, "%02d:%02d", f.hour, f.minute);
+        } else if (var == WO::LayoutVar::VAR_SECONDS) {
+            snprintf(buf, size, "%02d", f.second);
+        } else if (var == WO::LayoutVar::VAR_DATE) {
+            snprintf(buf, size, "%02d.%02d.%d", f.day, f.month, f.year);
+        } else {
+            long value = 0;
+            if (var == WO::LayoutVar::VAR_BRI) value = f.bri;
+            if (var == WO::LayoutVar::VAR_LEDS) value = f.ledCount;
+            if (var == WO::LayoutVar::VAR_POWER) value = f.power;
+            if (var == WO::LayoutVar::VAR_FPS) value = f.fps;
+            if (var == WO::LayoutVar::VAR_PRESET) value = f.preset;
+            if (var == WO::LayoutVar::VAR_PLAYLIST) value = f.playlist;
+            if (var == WO::LayoutVar::VAR_EFFECT) value = f.mode;
+            if (var == WO::LayoutVar::VAR_PALETTE) value = f.palette;
+            if (var == WO::LayoutVar::VAR_SPEED) value = f.speed;
+            if (var == WO::LayoutVar::VAR_INTENSITY) value = f.intensity;
+            if (var == WO::LayoutVar::VAR_SIGNAL) value = f.signal;
+            if (var == WO::LayoutVar::VAR_UPTIME) value = f.uptime;
+            ltoa(value, buf, 10); // much cheaper than snprintf, fits 16 bytes
+        }
+        return buf;
     }
 
+    // interpret user-defined screen bytecode
+    // it's validated by `loadLayouts` so no checks here
+    void drawLayout(const Frame& f) {
+        const uint8_t* pc = layoutData + layoutOffset[f.layout];
+        char buf[16];
+        // text before the first font instruction, don't reuse font of the previous screen
+        display.setFont(u8g2_font_profont10_tr);
+        for (;;) {
+            switch (pc[0]) {
+                case WO::LayoutOp::OP_FONT:
+                    display.setFont(WO::LAYOUT_FONTS[pc[1]]);
+                    break;
+                case WO::LayoutOp::OP_TEXT:
+                    display.drawStr(pc[1], pc[2], reinterpret_cast<const char*>(pc + 4));
+                    pc += WO::OP_SIZE[WO::LayoutOp::OP_TEXT] + pc[3];
+                    continue;
+                case WO::LayoutOp::OP_VAR:
+                    display.drawStr(pc[1], pc[2], formatVar(f, pc[3], buf, sizeof(buf)));
+                    break;
+                case WO::LayoutOp::OP_GLYPH:
+                    display.drawGlyph(pc[1], pc[2], pc[3] | (pc[4] << 8));
+                    break;
+                case WO::LayoutOp::OP_FRAME:
+                    display.drawFrame(pc[1], pc[2], pc[3], pc[4]);
+                    break;
+                case WO::LayoutOp::OP_BOX:
+                    display.drawBox(pc[1], pc[2], pc[3], pc[4]);
+                    break;
+                case WO::LayoutOp::OP_LINE:
+                    display.drawLine(pc[1], pc[2], pc[3], pc[4]);
+                    break;
+                default: // OP_END
+                    return;
+            }
+            pc += WO::OP_SIZE[pc[0]];
+        }
+    }
+#endif
+
     void drawStar() {
-        auto r = ESP.random();
+#ifdef ARDUINO_ARCH_ESP32
+        uint32_t r = esp_random();
+#else
+        uint32_t r = ESP.random();
+#endif
         u8g2_uint_t x = r & 63;
         u8g2_uint_t y = (r >> 6) % 48;
         display.drawPixel(x, y);
@@ -601,16 +1641,15 @@ private:
         display.setDrawColor(1);
     }
 
-    void drawClock() {
-        u8g2_uint_t y = animationFrame % 29;
-        u8g2_uint_t x = animationFrame / 29;
+    void drawClock(const Frame& f) {
+        u8g2_uint_t y = f.animationFrame % 29;
+        u8g2_uint_t x = f.animationFrame / 29;
         if ((x & 1) > 0) {
             y = 28 - y;
         }
         display.setFont(u8g2_font_profont22_tn);
         display.setCursor(x, y + 19);
-        updateLocalTime();
-        display.printf("%02d:%02d", hour(localTime), minute(localTime)); //HH:MM
+        display.printf("%02d:%02d", f.hour, f.minute); //HH:MM
     }
 
     void showScreensaver() {
@@ -623,11 +1662,6 @@ private:
             return;
         }
         if (screenSaver == WO::Screen::SCREENSAVER_NIGHTSKY) {
-            if (renderedScreen != WO::Screen::SCREENSAVER_NIGHTSKY) {
-                // first drawing
-                display.clearBuffer();
-            }
-            drawStar();
             show();
             return;
         }
@@ -635,8 +1669,6 @@ private:
             // first drawing
             animationFrame = 0;
         }
-        startDrawing(false);
-        drawClock();
         show();
         if (animationFrame == 0) ssClockMoveForward = true;
         if (animationFrame == 202) ssClockMoveForward = false;
@@ -657,35 +1689,113 @@ public:
         enabled(false),
         lowContrast(0),
         highContrast(127),
+        adaptiveContrast(false),
+        pixelShift(false),
+        contrast(127),
+        targetContrast(127),
+        contrastFadeStep(1),
+        contrastLitPixels(0),
+        lastContrastStep(0),
+        shiftPhase(0),
+        panelOn(true),
+        frame(),
+        displayOn(true),
+        displayContrast(127),
+        drawnFrame(0),
+        drawnScreen(WO::Screen::NOTHING),
+        sentBuffer(),
+        litPixels(0),
+        pageLitPixels(),
+        pageWear(),
+        wearHours(0),
+        lastWearUpdate(0),
+#ifdef WO_RENDER_TASK
+        renderTask(nullptr),
+#endif
+        btnTimeout(WO::BTN_TIMEOUT),
+        menuExitTimeout(WO::MENU_EXIT_TIMEOUT),
+        screensaverTimeout(WO::SCREENSAVER_TIMEOUT),
+        highlightTimeout(WO::HIGHLIGHT_TIMEOUT),
+        clockRate(WO::CLOCK_RATE),
+        ledRate(WO::LED_RATE),
+        infoRate(WO::INFO_RATE),
+        aboutRate(WO::ABOUT_RATE),
+        maxBytesPerSec(0),
+        budget(int32_t(WO::FRAME_BYTES) * 1000),
+        lastBudgetUpdate(0),
         ready(false), 
         redraw(false),
         menu(false),
         screenSaving(false),
+        highlighting(false),
         ssClockMoveForward(true),
+        actionHeld(false),
+        repeating(false),
+        statePending(false),
+        configUpdated(false),
+        newEnabled(false),
+        lastStateChange(0),
+#ifndef WEMOS_OLED_NO_CUSTOM_SCREENS
+        layoutData(),
+        layoutOffset(),
+        layoutVars(),
+        layoutCount(0),
+        customPage(0),
+#endif
+#ifndef WEMOS_OLED_NO_SEGMENTS_SCREEN
+        segmentCache(),
+        activeSegments(0),
+        segmentPage(0),
+        segmentScan(0),
+        lastPageFlip(0),
+#endif
         activeScreen(WO::Screen::WIFI),
         renderedScreen(WO::Screen::NOTHING),
-        screenSaver(WO::Screen::SCREENSAVER_CLOCK),
+        screenSaver(isScreenEnabled(WO::Screen::SCREENSAVER_CLOCK) ?
+            WO::Screen::SCREENSAVER_CLOCK : WO::Screen::SCREENSAVER_EMPTY),
         wifiState(WO::WifiMode::NONE),
         animationFrame(0) {
     }
 
     void setup() {
-        display.begin();
+        display.begin(); // leaves display cleared and powered on
+        display.setContrast(displayContrast);
+#ifdef WO_RENDER_TASK
+        // WLED loop runs on one core, render on the other one
+        BaseType_t core = xPortGetCoreID() == 0 ? 1 : 0;
+        if (xTaskCreatePinnedToCore(renderLoop, "wemos_oled", WO::RENDER_TASK_STACK, this,
+                WO::RENDER_TASK_PRIORITY, &renderTask, core) != pdPASS) {
+            renderTask = nullptr; // render in `loop`
+        }
+#endif
+#ifndef WEMOS_OLED_NO_CUSTOM_SCREENS
+        loadLayouts();
+#endif
+        fillConstantInfo();
         ready = true;
         if (enabled) {
             wakeUp(); // save actual activation time
             enable();
             activeScreen = WO::Screen::SPLASH;
-            startDrawing(false);
-            drawSplash();
             show();
+            ++animationFrame;
         } else {
             disable();
         }
     }
 
     void loop() {
+        if (configUpdated) applyConfig();
         if (!enabled || strip.isUpdating()) return;
+        refillBudget();
+        // lit pixels are counted when frame is rendered, possibly by render task
+        if (adaptiveContrast && litPixels != contrastLitPixels) {
+            updateContrast();
+        }
+        fadeContrast();
+        if (statePending && millis() - lastStateChange >= WO::STATE_UPDATE_DELAY) {
+            publishState();
+        }
         if (screenSaving) {
             if (isScreensaverRedrawNeeded()) {
                 showScreensaver();
@@ -701,7 +1811,7 @@ public:
             }    
         }
 
-        if (activeScreen == WO::Screen::WIFI) {
+        if (activeScreen == WO::Screen::WIFI || activeScreen == WO::Screen::CUSTOM) {
             WO::WifiMode newState(WO::WifiMode::NONE);
             if (apActive) {
                 newState = WO::WifiMode::AP;
@@ -714,48 +1824,43 @@ public:
             }
         }
 
-        if (activeScreen == WO::Screen::FX || activeScreen == WO::Screen::LED) {
+        if (activeScreen == WO::Screen::FX || activeScreen == WO::Screen::LED ||
+            activeScreen == WO::Screen::CUSTOM) {
             if (stateChanged) redraw = true;
         }
 
-        auto inactivityPeriod = millis() - mostRecentAction();
-        if (highlighting && inactivityPeriod >= WO::HIGHLIGHT_TIMEOUT) {
+#ifndef WEMOS_OLED_NO_SEGMENTS_SCREEN
+        if (activeScreen == WO::Screen::SEGMENTS) {
+            updateSegments();
+        }
+#endif
+
+        uint32_t inactivityPeriod = millis() - mostRecentAction();
+        if (highlighting && inactivityPeriod >= highlightTimeout) {
             setIdle();
         }
-        if (menu && inactivityPeriod >= WO::MENU_EXIT_TIMEOUT) {
+        if (menu && inactivityPeriod >= menuExitTimeout) {
             exitMenu();
         } 
-        if (inactivityPeriod >= WO::SCREENSAVER_TIMEOUT) {
+        if (inactivityPeriod >= screensaverTimeout) {
             screenSaving = true;
             return;
         }
-        
-        if (!isRedrawNeeded()) return; //nothing to display
-
-        // two special cases: splash and menu
-        if (activeScreen == SPLASH) {
-            startDrawing(false);
-            drawSplash();
-            show();
-            return;
-        }
 
-        if (menu) {
-            startDrawing(false);
-            drawMenuItem();
-            show();
-            return;
+        if (pixelShift) {
+            uint8_t newPhase = (millis() / WO::PIXEL_SHIFT_PERIOD) & 3;
+            if (newPhase != shiftPhase) {
+                shiftPhase = newPhase;
+                redraw = true;
+            }
         }
+        
+        if (!isRedrawNeeded()) return; //nothing to display
 
-        startDrawing();
-        if (activeScreen == WO::Screen::WIFI) drawWifiData();
-        if (activeScreen == WO::Screen::LED) drawLedInfo();
-        if (activeScreen == WO::Screen::FX) drawFxInfo();
-        if (activeScreen == WO::Screen::TECH_INFO) drawTechInfo();
-        if (activeScreen == WO::Screen::TIME_AND_DATE) drawTimeAndDate();
-        if (activeScreen == WO::Screen::DISPLAY_INFO) drawDisplayInfo();
-        if (activeScreen == WO::Screen::ABOUT) drawAbout();
         show();
+        if (activeScreen == WO::Screen::SPLASH) {
+            animationFrame = (animationFrame + 1) & 3;
+        }
     }
 
     bool handleButton(uint8_t b) {
@@ -763,24 +1868,32 @@ public:
         if (!enabled || b > 1) return false;
         if (activeScreen == WO::Screen::SPLASH) return true;
         
-        auto now = millis();
+        uint32_t now = millis();
 
         if (b == 1) { // next
-            if (now - lastActionPress < WO::BTN_TIMEOUT) return true;
-            if (isButtonPressed(1)) {
-                lastActionPress = now;
-                if (wakeUp()) {
-                    return true;
-                }
-                if (menu) {
-                    executeAction();
-                } else {
-                    nextScreen();
-                }
-            } 
+            if (!isButtonPressed(1)) {
+                actionHeld = false;
+                return true;
+            }
+            auto timeout = btnTimeout;
+            if (actionHeld && isRepeatable()) {
+                timeout = repeating ? WO::REPEAT_RATE : WO::REPEAT_DELAY;
+            }
+            if (now - lastActionPress < timeout) return true;
+            repeating = actionHeld;
+            actionHeld = true;
+            lastActionPress = now;
+            if (wakeUp()) {
+                return true;
+            }
+            if (menu) {
+                executeAction();
+            } else {
+                nextScreen();
+            }
         }
         if (b == 0) {
-            if (now - lastMenuPress < WO::BTN_TIMEOUT) return true;
+            if (now - lastMenuPress < btnTimeout) return true;
             if (isButtonPressed(0)) {
                 lastMenuPress = now;
                 if (wakeUp()) {
@@ -802,15 +1915,55 @@ public:
         top["loctr"] = lowContrast;
         top["hictr"] = highContrast;
         top["screensaver"] = uint8_t(screenSaver) - 251;
+        top["adaptive"] = adaptiveContrast;
+        top["pxshift"] = pixelShift;
+        top["btn"] = btnTimeout;
+        top["menuexit"] = menuExitTimeout / 1000;
+        top["sstimeout"] = screensaverTimeout / 1000;
+        top["idle"] = highlightTimeout / 1000;
+        top["clockrate"] = clockRate;
+        top["ledrate"] = ledRate;
+        top["inforate"] = infoRate;
+        top["aboutrate"] = aboutRate;
+        top["maxbps"] = maxBytesPerSec;
+    }
+
+    void addToJsonInfo(JsonObject& root) {
+        if (!enabled) return;
+        JsonObject user = root["u"];
+        if (user.isNull()) user = root.createNestedObject("u");
+
+        JsonArray current = user.createNestedArray(F("OLED current"));
+        current.add(estimateCurrent());
+        current.add(F(" uA"));
+
+        JsonArray wear = user.createNestedArray(F("OLED max page wear"));
+        wear.add(uint32_t(wearHours));
+        wear.add(F(" h"));
     }
 
     void appendConfigData() {
         oappend(SET_F("addInfo('Display:loctr', 1, 'Inactive display contrast (0..255)');"));
         oappend(SET_F("addInfo('Display:hictr', 1, 'Active display contrast (0..255)');"));
         oappend(SET_F("dd=addDropdown('Display','screensaver');"));
+#ifndef WEMOS_OLED_NO_NIGHTSKY
         oappend(SET_F("addOption(dd,'Night Sky',0);"));
+#endif
+#ifndef WEMOS_OLED_NO_CLOCK_SCREENSAVER
         oappend(SET_F("addOption(dd,'Moving Clock',1);"));
+#endif
         oappend(SET_F("addOption(dd,'Empty Screen',2);"));
+        oappend(SET_F("addInfo('Display:adaptive', 1, 'Dim frames with many lit pixels');"));
+        oappend(SET_F("addInfo('Display:pxshift', 1, 'Shift image by a pixel every 5 min');"));
+        oappend(SET_F("addInfo('Display:btn', 1, 'Button debounce timeout (20..2000 ms)');"));
+        oappend(SET_F("addInfo('Display:menuexit', 1, 'Quit menu after inactivity (5..86400 s)');"));
+        oappend(SET_F("addInfo('Display:sstimeout', 1, 'Start screensaver after inactivity (5..86400 s)');"));
+        oappend(SET_F("addInfo('Display:idle', 1, 'Set inactive contrast after inactivity (5..86400 s)');"));
+        oappend(SET_F("addInfo('Display:clockrate', 1, 'Clock and screensaver update rate (ms)');"));
+        oappend(SET_F("addInfo('Display:ledrate', 1, 'LED and effect screens update rate (ms)');"));
+        oappend(SET_F("addInfo('Display:inforate', 1, 'Other screens update rate (ms)');"));
+        oappend(SET_F("addInfo('Display:aboutrate', 1, 'About screen update rate (ms)');"));
+        oappend(SET_F("addInfo('Display:maxbps', 1, 'Max display I2C traffic (bytes/s, 0 - unlimited)');"));
     }
 
     bool readFromConfig(JsonObject& root) {
@@ -822,22 +1975,51 @@ public:
             lowContrast = highContrast;
         }
         screenSaver = WO::Screen(uint8_t(top["screensaver"] | 0) + 251) ;
+        if (!isScreenEnabled(screenSaver)) {
+            screenSaver = WO::Screen::SCREENSAVER_EMPTY;
+        }
+        adaptiveContrast = top["adaptive"] | adaptiveContrast;
+        pixelShift = top["pxshift"] | pixelShift;
+        btnTimeout = constrain(top["btn"] | btnTimeout, WO::MIN_BTN_TIMEOUT, WO::MAX_BTN_TIMEOUT);
+        // limit periods so they elapse long before millis() wraps around,
+        // too short timeouts would close menu or start screensaver right after wake up
+        menuExitTimeout = constrain(top["menuexit"] | (menuExitTimeout / 1000),
+            WO::MIN_TIMEOUT / 1000, WO::MAX_TIMEOUT / 1000) * 1000;
+        screensaverTimeout = constrain(top["sstimeout"] | (screensaverTimeout / 1000),
+            WO::MIN_TIMEOUT / 1000, WO::MAX_TIMEOUT / 1000) * 1000;
+        highlightTimeout = constrain(top["idle"] | (highlightTimeout / 1000),
+            WO::MIN_TIMEOUT / 1000, WO::MAX_TIMEOUT / 1000) * 1000;
+        clockRate = constrain(top["clockrate"] | clockRate, 100UL, WO::MAX_TIMEOUT);
+        ledRate = constrain(top["ledrate"] | ledRate, 100UL, WO::MAX_TIMEOUT);
+        infoRate = constrain(top["inforate"] | infoRate, 100UL, WO::MAX_TIMEOUT);
+        aboutRate = constrain(top["aboutrate"] | aboutRate, 100UL, WO::MAX_TIMEOUT);
+        maxBytesPerSec = top["maxbps"] | maxBytesPerSec;
+        if (maxBytesPerSec > 0 && maxBytesPerSec < WO::FRAME_BYTES / 10) {
+            maxBytesPerSec = WO::FRAME_BYTES / 10; // at least one frame per 10 sec
+        }
         if (ready) {
-            wakeUp();
-            if (enabled != newState) {
-                if (newState) {
-                    enable();
-                    redraw = true;
-                } else {
-                    disable();
-                }
-            }
+            // settings may be saved outside of WLED loop,
+            // display is accessed from `loop` only
+            newEnabled = newState;
+            configUpdated = true;
+        } else {
+            enabled = newState;
         }
-        enabled = newState;
         return true;
     }
 
     uint16_t getId() {
         return USERMOD_ID_WEMOS_OLED; // defined in const.h
     }
-};
\ No newline at end of file
+};
+#if __cplusplus < 201703L
+// before C++17 static constexpr members used at runtime need a definition,
+// the usermod is included by a single translation unit (usermods_list.cpp)
+constexpr uint32_t WemosOledUsermod::MAX_BUDGET_PERIOD;
+constexpr uint8_t WemosOledUsermod::SHIFT_X[];
+constexpr uint8_t WemosOledUsermod::SHIFT_Y[];
+constexpr uint16_t WemosOledUsermod::SCREEN_ICON[];
+constexpr const char* WemosOledUsermod::DAY_NAME[];
+constexpr uint8_t WemosOledUsermod::OP_SIZE[];
+constexpr const uint8_t* WemosOledUsermod::LAYOUT_FONTS[];
+#endif